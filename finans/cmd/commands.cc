@@ -0,0 +1,1050 @@
+// Copyright (2015) Gustav
+
+#include "finans/cmd/commands.h"
+
+#include <fstream>  // NOLINT this is how we use fstrean
+#include <limits>
+#include <map>
+#include <string>
+#include <tuple>
+
+#include "finans/core/finans.h"
+
+#include "finans/core/batch.h"
+#include "finans/core/commandline.h"
+#include "finans/core/dateformat.h"
+#include "finans/core/dateparser.h"
+#include "finans/core/datetime.h"
+#include "finans/core/day.h"
+#include "finans/core/server.h"
+#include "finans/core/stringutils.h"
+
+ARGPARSE_DEFINE_ENUM(SnapshotFormat, "format", ("json", SnapshotFormat::JSON)("binary", SnapshotFormat::BINARY))
+
+enum class ReportType {
+  ENVELOPES, YEARS
+};
+ARGPARSE_DEFINE_ENUM(ReportType, "report", ("envelopes", ReportType::ENVELOPES)("years", ReportType::YEARS))
+ARGPARSE_DEFINE_ENUM(DateOrder, "date format", ("ymd", DateOrder::YEAR_MONTH_DAY)("dmy", DateOrder::DAY_MONTH_YEAR)("mdy", DateOrder::MONTH_DAY_YEAR))
+
+int ExceptionHandler(Session* session) {
+  try {
+    throw;
+  }
+  catch (const std::string& error) {
+    session->err() << "error: " << error << "\n";
+    session->set_result(-13);
+  }
+  catch (const char* error) {
+    session->err() << "error: " << error << "\n";
+    session->set_result(-14);
+  }
+  catch (...) {
+    session->err() << "Unknown error.\n";
+    session->set_result(-42);
+  }
+  return session->result();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+Session::Session(std::istream* in, std::ostream* out, std::ostream* err)
+  : in_(in)
+  , out_(out)
+  , err_(err)
+  , result_(0)
+  , deferred_commit_(false)
+  , has_uncommitted_(false)
+  , server_(nullptr) {
+}
+
+std::istream& Session::in() {
+  return *in_;
+}
+
+std::ostream& Session::out() {
+  return *out_;
+}
+
+std::ostream& Session::err() {
+  return *err_;
+}
+
+void Session::set_streams(std::istream* in, std::ostream* out, std::ostream* err) {
+  in_ = in;
+  out_ = out;
+  err_ = err;
+}
+
+std::shared_ptr<Finans> Session::GetFinans() {
+  // a server keeps finans between commands, so it needs to pick up changes
+  // made by others. changes we haven't saved yet are kept
+  if (finans_.get() != nullptr && has_uncommitted_ == false && finans_->IsChangedOnDisk()) {
+    finans_.reset();
+  }
+  if (finans_.get() == nullptr) {
+    finans_ = Finans::CreateNew();
+  }
+  return finans_;
+}
+
+void Session::Commit() {
+  has_uncommitted_ = true;
+  if (deferred_commit_ == false) Flush();
+}
+
+void Session::Invalidate() {
+  Flush();
+  finans_.reset();
+}
+
+bool Session::deferred_commit() const {
+  return deferred_commit_;
+}
+
+void Session::set_deferred_commit(bool deferred) {
+  deferred_commit_ = deferred;
+}
+
+void Session::Flush() {
+  if (has_uncommitted_ && finans_.get() != nullptr) finans_->Save();
+  has_uncommitted_ = false;
+}
+
+int Session::result() const {
+  return result_;
+}
+
+void Session::set_result(int result) {
+  result_ = result;
+}
+
+CommandServer* Session::server() {
+  return server_;
+}
+
+void Session::set_server(CommandServer* server) {
+  server_ = server;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// commands are run one at a time, fin serve included
+UtcOffsetTable* LocalTime() {
+  static UtcOffsetTable local_time;
+  return &local_time;
+}
+
+// YYYY-MM-DD as the start of that day in local time
+Day ParseDay(const std::string& date) {
+  ParsedDate parsed;
+  if (false == ParseDate(date.data(), date.data() + date.size(), DateOrder::YEAR_MONTH_DAY, &parsed) || parsed.seconds != 0) {
+    throw "Invalid date " + date + ", expected YYYY-MM-DD";
+  }
+  return Day::FromCivil(parsed.year, parsed.month, parsed.day);
+}
+
+int64_t ParseDateArgument(const std::string& date) {
+  return ParseDay(date).LocalStart(LocalTime());
+}
+
+// the start of the day after, or now if no date was given
+int64_t EndOfDayArgument(const std::string& date) {
+  if (date.empty()) return static_cast<int64_t>(DateTimeToInt64(DateTime::CurrentTime().time()));
+  return (ParseDay(date) + 1).LocalStart(LocalTime());
+}
+
+const DateFormat& DayFormat() {
+  static const DateFormat format("%Y-%m-%d");
+  return format;
+}
+
+std::string FormatDate(int64_t when) {
+  std::string date;
+  DayFormat().AppendLocal(when, LocalTime(), &date);
+  return date;
+}
+
+std::string FormatMoney(const Finans& finans, int currency, int64_t cents) {
+  return finans.GetMoneyFormat(currency).Format(cents);
+}
+
+// listings are built in one buffer and written in large pieces, instead
+// of going through the stream for every value
+const std::size_t OUTPUT_BUFFER_SIZE = 64 * 1024;
+
+void WriteIfFull(std::ostream& out, std::string* buffer) {
+  if (buffer->size() < OUTPUT_BUFFER_SIZE) return;
+  out.write(buffer->data(), buffer->size());
+  buffer->clear();
+}
+
+void Write(std::ostream& out, std::string* buffer) {
+  out.write(buffer->data(), buffer->size());
+  buffer->clear();
+}
+
+void AppendExternalExchange(const Finans& finans, const ExternalExchangeRow& x, std::string* out) {
+  DayFormat().AppendLocal(x.when, LocalTime(), out);
+  *out += "  ";
+  *out += finans.GetAccountName(x.account);
+  *out += "  ";
+  *out += finans.GetCompanyName(x.company);
+  *out += "  ";
+  *out += x.category >= 0 ? finans.GetCategoryName(x.category) : "-";
+  *out += "  ";
+  finans.GetMoneyFormat(finans.GetAccountCurrency(x.account)).Append(x.value, out);
+  *out += '\n';
+}
+
+void AppendInternalExchange(const Finans& finans, const InternalExchangeRow& x, std::string* out) {
+  DayFormat().AppendLocal(x.when, LocalTime(), out);
+  *out += "  ";
+  *out += finans.GetAccountName(x.from_account);
+  *out += " -> ";
+  *out += finans.GetAccountName(x.to_account);
+  *out += "  ";
+  finans.GetMoneyFormat(x.from_currency).Append(-x.from_value, out);
+  *out += "  ";
+  finans.GetMoneyFormat(x.to_currency).Append(x.to_value, out);
+  *out += '\n';
+}
+
+void PrintReconcileReport(std::ostream& out, const Finans& finans, const ReconcileReport& report) {
+  std::string buffer;
+  for (const auto& row : report.rows) {
+    if (row.status == ReconcileStatus::NEW) continue;
+    buffer += row.status == ReconcileStatus::MATCHED ? "matched    " : "ambiguous  ";
+    DayFormat().AppendLocal(row.when, LocalTime(), &buffer);
+    buffer += "  ";
+    buffer += finans.GetCompanyName(row.company);
+    buffer += "  ";
+    finans.GetMoneyFormat(finans.GetAccountCurrency(row.account)).Append(row.value, &buffer);
+    buffer += " (" + std::to_string(row.matches.size()) + " in the ledger)\n";
+    WriteIfFull(out, &buffer);
+  }
+  Write(out, &buffer);
+  out << report.added << " new, " << report.matched << " matched, " << report.ambiguous << " ambiguous, only the new are imported.\n";
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// base for all commands, they all run against a session
+class Command : public argparse::SubParser {
+public:
+  explicit Command(Session* session) : session_(session) { }
+
+protected:
+  Session* session_;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+class cmd_status : public Command {
+  bool timing_;
+  bool verify_;
+
+public:
+  explicit cmd_status(Session* session) : Command(session), timing_(false), verify_(false) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Give the status of your finances");
+    parser.StoreConst("--timing", timing_, true).help("Show how long it took to load the data");
+    parser.StoreConst("--verify", verify_, true).help("Recompute the balances from all exchanges and compare");
+  }
+  void ParseCompleted() override {
+    try {
+      auto finans = session_->GetFinans();
+      session_->out() << "Number of accounts: " << finans->NumberOfAccounts() << "\n";
+      session_->out() << "Number of companies: " << finans->NumberOfCompanies() << "\n";
+      session_->out() << "Number of currencies: " << finans->NumberOfCurrencies() << "\n";
+      session_->out() << "Number of categories: " << finans->NumberOfCategories() << "\n";
+      for (int account = 0; account < finans->NumberOfAccounts(); ++account) {
+        for (const auto currency : finans->GetBalanceCurrencies(account)) {
+          session_->out() << finans->GetAccountName(account) << ": "
+            << FormatMoney(*finans, currency, finans->GetBalance(account, currency)) << "\n";
+        }
+      }
+      if (verify_) {
+        const bool ok = finans->VerifyBalances();
+        session_->out() << "Balances: " << (ok ? "ok" : "MISMATCH") << "\n";
+        if (!ok) session_->set_result(-2);
+      }
+      if (timing_) {
+        const auto& t = finans->load_timing();
+        const char* cache = t.cache_enabled ? (t.cache_hit ? "hit" : "miss") : "not used";
+        session_->out() << "Cache: " << cache << "\n";
+        session_->out() << "Snapshot load: " << t.snapshot << " ms\n";
+        session_->out() << "Journal replay: " << t.journal << " ms (" << t.journal_records << " changes)\n";
+        session_->out() << "Total load: " << t.total << " ms\n";
+      }
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_addrate : public Command {
+  std::string from_;
+  std::string to_;
+  double rate_;
+  std::string date_;
+
+public:
+  explicit cmd_addrate(Session* session) : Command(session), rate_(0) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Add a exchange rate between two currencies");
+    parser.AddOption("from", from_).help("The currency to convert from, ie. USD");
+    parser.AddOption("to", to_).help("The currency to convert to, ie. SEK");
+    parser.AddOption("rate", rate_).help("How many to you get for one from");
+    parser.AddOption("--date", date_).help("The first day the rate is valid, YYYY-MM-DD, defaults to now");
+  }
+
+  void ParseCompleted() override {
+    try {
+      auto finans = session_->GetFinans();
+      const auto from = finans->GetCurrencyByName(from_);
+      if (from == -1) throw "Unknown from currency";
+      const auto to = finans->GetCurrencyByName(to_);
+      if (to == -1) throw "Unknown to currency";
+      const auto when = date_.empty() ? static_cast<int64_t>(DateTimeToInt64(DateTime::CurrentTime().time())) : ParseDateArgument(date_);
+      finans->AddRate(from, to, rate_, when);
+      session_->Commit();
+      session_->out() << "Rate added.\n";
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_networth : public Command {
+  std::string currency_;
+  std::string date_;
+
+public:
+  explicit cmd_networth(Session* session) : Command(session) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("The sum of all accounts in one currency");
+    parser.AddOption("currency", currency_).help("The currency to report in");
+    parser.AddOption("--date", date_).help("The day to report at the end of, YYYY-MM-DD, defaults to now");
+  }
+
+  void ParseCompleted() override {
+    try {
+      auto finans = session_->GetFinans();
+      const auto currency = finans->GetCurrencyByName(currency_);
+      if (currency == -1) throw "Unknown currency";
+      const auto worth = finans->GetNetWorth(currency, EndOfDayArgument(date_));
+      session_->out() << FormatMoney(*finans, currency, worth) << "\n";
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_addcurrecy : public Command {
+  std::string longNamneArg;
+  std::string shortNameArg;
+  std::string beforeArg;
+  std::string afterArg;
+
+public:
+  explicit cmd_addcurrecy(Session* session) : Command(session) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Add a currency to finans");
+    parser.AddOption("name",       longNamneArg).help("The long name, ie. 'American Dollar'");
+    parser.AddOption("short-name", shortNameArg).help("The short name ie. USD");
+    parser.AddOption("before",     beforeArg   ).help("The string before a value, ie. the $ in $99");
+    parser.AddOption("after",      afterArg    ).help("The string after a value, ie. the kr in 45 kr");
+  }
+
+  void ParseCompleted() override {
+    try {
+      auto finans = session_->GetFinans();
+      finans->AddCurency(longNamneArg, shortNameArg, beforeArg, afterArg);
+      session_->Commit();
+      session_->out() << "Added " << shortNameArg << ".\n";
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_addaccount : public Command {
+  std::string long_name_;
+  std::string short_name_;
+  std::string currency_name_;
+
+public:
+  explicit cmd_addaccount(Session* session) : Command(session) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Add a account to finans");
+    parser.AddOption("name",      long_name_).help( "The name, ie. 'My card'");
+    parser.AddOption("short-name",short_name_).help( "The short name ie. Visa");
+    parser.AddOption("currency",  currency_name_ ).help( "The default currency for this account");
+  }
+
+  void ParseCompleted() override {
+    try {
+      auto finans = session_->GetFinans();
+      auto currency = finans->GetCurrencyByName(currency_name_);
+      if (currency == -1) throw "Unknown currency";
+      finans->AddAccount(long_name_, short_name_, currency);
+      session_->Commit();
+      session_->out() << "Added " << short_name_ << ".\n";
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_addcompany : public Command {
+  std::string company_name_;
+  std::string currency_name_;
+
+public:
+  explicit cmd_addcompany(Session* session) : Command(session) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Add a company to finans");
+    parser.AddOption("name", company_name_).help( "The name, ie. 'Acme'");
+    parser.AddOption("currency", currency_name_).help( "The default currency this company works in");
+  }
+
+  void ParseCompleted() override {
+    try {
+      auto finans = session_->GetFinans();
+      auto currency = finans->GetCurrencyByName(currency_name_);
+      if (currency == -1) throw "Unknown currency";
+      finans->AddCompany(company_name_, currency);
+      session_->Commit();
+      session_->out() << "Added " << company_name_ << ".\n";
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_addcategory : public Command {
+  std::string category_name_;
+
+public:
+  explicit cmd_addcategory(Session* session) : Command(session) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Add a category/envelope to finans");
+    parser.AddOption("name", category_name_).help( "The name, ie. 'Savings'");
+  }
+
+  void ParseCompleted() override {
+    try {
+      auto finans = session_->GetFinans();
+      finans->AddCategory(category_name_);
+      session_->Commit();
+      session_->out() << "Added " << category_name_ << ".\n";
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_list : public Command {
+  std::string from_;
+  std::string to_;
+  std::string account_;
+
+public:
+  explicit cmd_list(Session* session) : Command(session) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("List the exchanges in a period of time");
+    parser.AddOption("--from", from_).help("The first day to list, YYYY-MM-DD");
+    parser.AddOption("--to", to_).help("The day after the last day to list, YYYY-MM-DD");
+    parser.AddOption("--account", account_).help("Only list the exchanges of this account, and sum them");
+  }
+
+  void ParseCompleted() override {
+    try {
+      const auto from = from_.empty() ? std::numeric_limits<int64_t>::min() : ParseDateArgument(from_);
+      const auto to = to_.empty() ? std::numeric_limits<int64_t>::max() : ParseDateArgument(to_);
+      auto finans = session_->GetFinans();
+      const auto account = account_.empty() ? -1 : finans->GetAccountByName(account_);
+      if (account_.empty() == false && account == -1) throw "Unknown account";
+      const auto external = finans->GetExternalExchangesBetween(from, to);
+      const auto internal = finans->GetInternalExchangesBetween(from, to);
+
+      // both lists are sorted, so merge them to list everything in order
+      std::string buffer;
+      auto e = external.begin();
+      auto i = internal.begin();
+      while (e != external.end() || i != internal.end()) {
+        const bool take_external = i == internal.end() ||
+          (e != external.end() && finans->GetExternalExchange(*e).when <= finans->GetInternalExchange(*i).when);
+        if (take_external) {
+          const auto x = finans->GetExternalExchange(*e);
+          ++e;
+          if (account != -1 && x.account != account) continue;
+          AppendExternalExchange(*finans, x, &buffer);
+        }
+        else {
+          const auto x = finans->GetInternalExchange(*i);
+          ++i;
+          if (account != -1 && x.from_account != account && x.to_account != account) continue;
+          AppendInternalExchange(*finans, x, &buffer);
+        }
+        WriteIfFull(session_->out(), &buffer);
+      }
+      Write(session_->out(), &buffer);
+      if (account != -1) {
+        session_->out() << "Sum of external exchanges: "
+          << FormatMoney(*finans, finans->GetAccountCurrency(account), finans->SumExternalExchanges(account, from, to)) << "\n";
+      }
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_query : public Command {
+  std::vector<std::string> words_;
+  std::string currency_;
+
+public:
+  explicit cmd_query(Session* session) : Command(session) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("List the exchanges matching a query, ie. category=Food and when>=2015-01-01 and value<-10000");
+    parser.AddGreedy("query", words_, "condition");
+    parser.AddOption("--currency", currency_).help("Sum the exchanges in this currency, at the rate of each day. Must come before the query");
+  }
+
+  void ParseCompleted() override {
+    try {
+      std::string query;
+      for (const auto& w : words_) {
+        if (query.empty() == false) query += " ";
+        query += w;
+      }
+      auto finans = session_->GetFinans();
+      const auto found = finans->QueryExternalExchanges(query);
+      std::string buffer;
+      for (const auto index : found) {
+        AppendExternalExchange(*finans, finans->GetExternalExchange(index), &buffer);
+        WriteIfFull(session_->out(), &buffer);
+      }
+      Write(session_->out(), &buffer);
+      session_->out() << found.size() << " exchanges\n";
+      if (currency_.empty() == false) {
+        const auto currency = finans->GetCurrencyByName(currency_);
+        if (currency == -1) throw "Unknown currency";
+        std::vector<int64_t> converted;
+        if (false == finans->ConvertExternalExchanges(currency, &converted)) {
+          session_->err() << "warning: some currencies have no rate and are not included\n";
+        }
+        int64_t sum = 0;
+        for (const auto index : found) {
+          sum += converted[index];
+        }
+        session_->out() << "Sum: " << FormatMoney(*finans, currency, sum) << "\n";
+      }
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_balance : public Command {
+  std::string account_;
+  std::string date_;
+  std::string from_;
+  std::string to_;
+
+public:
+  explicit cmd_balance(Session* session) : Command(session) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Show the balance of a account, now, at the end of a day or for every day in a period");
+    parser.AddOption("account", account_).help("The short name of the account");
+    parser.AddOption("--date", date_).help("The day to show the balance at the end of, YYYY-MM-DD");
+    parser.AddOption("--from", from_).help("The first day of the period, YYYY-MM-DD");
+    parser.AddOption("--to", to_).help("The day after the last day of the period, YYYY-MM-DD");
+  }
+
+  void ParseCompleted() override {
+    try {
+      auto finans = session_->GetFinans();
+      const auto account = finans->GetAccountByName(account_);
+      if (account == -1) throw "Unknown account";
+      if (from_.empty() != to_.empty()) throw "Both --from and --to are needed for a period";
+      if (from_.empty() == false && ParseDay(to_) < ParseDay(from_)) throw "--to can't be before --from";
+
+      for (const auto currency : finans->GetBalanceCurrencies(account)) {
+        const auto& money = finans->GetMoneyFormat(currency);
+        if (from_.empty() == false) {
+          const auto first = ParseDay(from_);
+          const auto days = ParseDay(to_) - first;
+          const auto balances = finans->GetDailyBalances(account, currency, first, days);
+          std::string buffer;
+          for (int day = 0; day < days; ++day) {
+            DayFormat().Append(first + day, &buffer);
+            buffer += "  ";
+            money.Append(balances[day], &buffer);
+            buffer += '\n';
+            WriteIfFull(session_->out(), &buffer);
+          }
+          Write(session_->out(), &buffer);
+        }
+        else if (date_.empty() == false) {
+          const auto balance = finans->GetDailyBalances(account, currency, ParseDay(date_), 1);
+          session_->out() << money.Format(balance[0]) << "\n";
+        }
+        else {
+          session_->out() << money.Format(finans->GetBalance(account, currency)) << "\n";
+        }
+      }
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_report : public Command {
+  ReportType type_;
+  int threads_;
+
+public:
+  explicit cmd_report(Session* session) : Command(session), type_(ReportType::ENVELOPES), threads_(0) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Summarize the finances");
+    parser.AddOption("type", type_).help("envelopes (spending per category and month) or years (per category and year)");
+    parser.AddOption("--threads", threads_).help("Number of threads to use, 0 uses all cores");
+  }
+
+  void ParseCompleted() override {
+    try {
+      switch (type_) {
+      case ReportType::ENVELOPES:
+        ReportEnvelopes();
+        break;
+      case ReportType::YEARS:
+        ReportYears();
+        break;
+      }
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+
+private:
+  void ReportEnvelopes() {
+    auto finans = session_->GetFinans();
+    const auto report = finans->ReportEnvelopes(threads_);
+    std::string buffer;
+    int month = -1;
+    for (const auto& row : report.rows) {
+      if (row.month != month) {
+        month = row.month;
+        buffer += FormatDate(report.months[month]).substr(0, 7);
+        buffer += '\n';
+      }
+      buffer += "  ";
+      buffer += row.category == -1 ? std::string("(uncategorized)") : finans->GetCategoryName(row.category);
+      buffer += ": ";
+      finans->GetMoneyFormat(row.currency).Append(row.sum, &buffer);
+      buffer += " (" + std::to_string(row.count) + ")\n";
+      WriteIfFull(session_->out(), &buffer);
+    }
+    Write(session_->out(), &buffer);
+  }
+
+  // reads the monthly summaries, not the exchanges
+  void ReportYears() {
+    auto finans = session_->GetFinans();
+    const auto& summaries = finans->GetMonthlySummaries();
+    // year, category, currency
+    std::map<std::tuple<std::string, int, int>, int64_t> sums;
+    for (const auto month : summaries.GetMonths(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max())) {
+      const auto year = FormatDate(month).substr(0, 4);
+      for (const auto& row : summaries.GetRows(month)) {
+        sums[std::make_tuple(year, row.category, row.currency)] += row.sum;
+      }
+    }
+
+    std::string buffer;
+    std::string year;
+    for (const auto& s : sums) {
+      if (std::get<0>(s.first) != year) {
+        year = std::get<0>(s.first);
+        buffer += year;
+        buffer += '\n';
+      }
+      const auto category = std::get<1>(s.first);
+      buffer += "  ";
+      buffer += category == -1 ? std::string("(uncategorized)") : finans->GetCategoryName(category);
+      buffer += ": ";
+      finans->GetMoneyFormat(std::get<2>(s.first)).Append(s.second, &buffer);
+      buffer += '\n';
+    }
+    Write(session_->out(), &buffer);
+  }
+};
+
+class cmd_import : public Command {
+  std::string format_;
+  std::string file_;
+  std::string account_;
+  std::string separator_;
+  int date_column_;
+  DateOrder date_format_;
+  int payee_column_;
+  int amount_column_;
+  bool no_header_;
+  bool reconcile_;
+  std::string rules_;
+  int threads_;
+
+public:
+  explicit cmd_import(Session* session) : Command(session), separator_(","), date_column_(1), date_format_(DateOrder::YEAR_MONTH_DAY), payee_column_(2), amount_column_(3), no_header_(false), reconcile_(false), threads_(0) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Replace the finans data with the content of a json file, or add the exchanges of a csv bank statement to a account");
+    parser.AddOption("format", format_).help("The format of the file, json or csv");
+    parser.AddOption("file", file_).help("The file to import");
+    parser.AddOption("--account", account_).help("csv: the account the statement belongs to");
+    parser.AddOption("--separator", separator_).help("csv: the column separator");
+    parser.AddOption("--date-column", date_column_).help("csv: the column with the date, starting at 1");
+    parser.AddOption("--date-format", date_format_).help("csv: the order of the date parts, ymd (2015-03-31), dmy (31/03/2015) or mdy (03/31/2015)");
+    parser.AddOption("--payee-column", payee_column_).help("csv: the column with the payee, starting at 1");
+    parser.AddOption("--amount-column", amount_column_).help("csv: the column with the amount, starting at 1");
+    parser.StoreConst("--no-header", no_header_, true).help("csv: the first line is not column names");
+    parser.StoreConst("--reconcile", reconcile_, true).help("csv: only add the exchanges that aren't already in the ledger, and list the ones that are");
+    parser.AddOption("--rules", rules_).help("csv: a json rules file that sets the category and company from the payee");
+    parser.AddOption("--threads", threads_).help("csv: number of threads to use, 0 uses all cores");
+  }
+
+  void ParseCompleted() override {
+    try {
+      const auto format = ToLower(format_);
+      auto finans = session_->GetFinans();
+      if (format == "json") {
+        finans->ImportJson(file_);
+        session_->Commit();
+        session_->out() << "Imported " << file_ << ".\n";
+      }
+      else if (format == "csv") {
+        const auto account = finans->GetAccountByName(account_);
+        if (account == -1) throw "Unknown account, specify it with --account";
+        if (separator_.size() != 1) throw "The separator must be a single character";
+        CsvFormat csv;
+        csv.separator = separator_[0];
+        csv.header = !no_header_;
+        csv.date_column = date_column_ - 1;
+        csv.date_order = date_format_;
+        csv.payee_column = payee_column_ - 1;
+        csv.amount_column = amount_column_ - 1;
+        Rules rules;
+        if (rules_.empty() == false) {
+          const auto error = rules.Load(rules_);
+          if (error.empty() == false) throw "Unable to load rules " + rules_ + ": " + error;
+          rules.Compile();
+        }
+        ReconcileReport report;
+        const auto count = finans->ImportCsv(file_, account, csv, threads_, rules_.empty() ? nullptr : &rules, reconcile_ ? &report : nullptr);
+        // one save for the whole statement
+        session_->Commit();
+        if (reconcile_) PrintReconcileReport(session_->out(), *finans, report);
+        // so rules that never hit can be found and removed
+        for (const auto& rule : rules.rules()) {
+          session_->out() << "rule " << rule.pattern << ": " << rule.hits << " hits\n";
+        }
+        session_->out() << "Imported " << count << " exchanges from " << file_ << ".\n";
+      }
+      else {
+        throw "Unsupported import format";
+      }
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_export : public Command {
+  std::string format_;
+  std::string file_;
+
+public:
+  explicit cmd_export(Session* session) : Command(session) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Write the finans data to a file");
+    parser.AddOption("format", format_).help("The format of the file, ie. json");
+    parser.AddOption("file", file_).help("The file to export to");
+  }
+
+  void ParseCompleted() override {
+    try {
+      if (ToLower(format_) != "json") throw "Unsupported export format";
+      auto finans = session_->GetFinans();
+      finans->ExportJson(file_);
+      session_->out() << "Exported to " << file_ << ".\n";
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_convert : public Command {
+  SnapshotFormat format_;
+
+public:
+  explicit cmd_convert(Session* session) : Command(session), format_(SnapshotFormat::JSON) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Change how finans stores its data on this device");
+    parser.AddOption("format", format_).help("json (readable) or binary (fast)");
+  }
+
+  void ParseCompleted() override {
+    try {
+      session_->Invalidate();
+      Finans::Convert(format_);
+      session_->out() << "Converted.\n";
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_install : public Command {
+  std::string folder_;
+  bool dont_create_;
+
+public:
+  explicit cmd_install(Session* session) : Command(session), dont_create_(true) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Install finans to your system");
+    parser.AddOption("folder", folder_).help( "Where to install");
+    parser.StoreConst("dont-create", dont_create_, false);
+  }
+
+  void ParseCompleted() override {
+    try {
+      session_->Invalidate();
+      Finans::Install(folder_, !dont_create_);
+      session_->out() << "Install complete.\n";
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_serve : public Command {
+  bool stop_;
+
+public:
+  explicit cmd_serve(Session* session) : Command(session), stop_(false) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Keep finans loaded and run the commands from other fin processes");
+    parser.StoreConst("--stop", stop_, true).help("Stop the running server");
+  }
+
+  void ParseCompleted() override {
+    try {
+      auto* running = session_->server();
+      if (running != nullptr) {
+        if (stop_ == false) throw "Already serving";
+        running->Stop();
+        session_->out() << "Stopping.\n";
+        return;
+      }
+      if (stop_) throw "No server is running";
+      if (session_->deferred_commit()) throw "Can't serve from a batch";
+
+      const auto socket = ServerSocketPath();
+      if (socket.empty()) throw "Unable to find a place for the socket";
+
+      Session* session = session_;
+      CommandServer server([session](const std::vector<std::string>& arguments, std::istream& in, std::ostream& out, std::ostream& err) {
+        session->set_streams(&in, &out, &err);
+        return RunCommand(session, arguments);
+      });
+
+      std::istream& in = session_->in();
+      std::ostream& out = session_->out();
+      std::ostream& err = session_->err();
+      out << "Serving on " << socket << ".\n";
+      out.flush();
+      session_->set_server(&server);
+      const auto error = server.Serve(socket);
+      session_->set_server(nullptr);
+      session_->set_streams(&in, &out, &err);
+      if (error.empty() == false) throw error;
+    }
+    catch (...)
+    {
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+class cmd_batch : public Command {
+  std::string file_;
+  int commit_every_;
+
+public:
+  explicit cmd_batch(Session* session) : Command(session), commit_every_(0) { }
+
+  void AddParser(argparse::Parser& parser) override {
+    parser.set_description("Run several commands, one per line, with a single load and save");
+    parser.AddOption("--file", file_).help("Read the commands from a file instead of the standard input");
+    parser.AddOption("--commit-every", commit_every_).help("Save after this many commands, 0 only saves at the end");
+  }
+
+  void ParseCompleted() override {
+    try {
+      if (session_->deferred_commit()) throw "Batches can't be nested";
+      if (commit_every_ < 0) throw "Invalid commit interval";
+
+      std::ifstream file;
+      if (file_.empty() == false) {
+        file.open(file_.c_str());
+        if (!file) throw "Unable to open " + file_;
+      }
+      std::istream& in = file_.empty() ? session_->in() : file;
+
+      session_->set_deferred_commit(true);
+      int line_number = 0;
+      int commands = 0;
+      int failed = 0;
+      int since_commit = 0;
+      std::string line;
+      std::vector<std::string> arguments;
+      while (std::getline(in, line)) {
+        ++line_number;
+        const auto error = ParseBatchLine(line, &arguments);
+        if (error.empty() == false) {
+          session_->err() << "error: line " << line_number << ": " << error << "\n";
+          ++failed;
+          continue;
+        }
+        if (arguments.empty()) continue;
+
+        ++commands;
+        if (RunCommand(session_, arguments) != 0) {
+          session_->err() << "error: line " << line_number << " failed\n";
+          ++failed;
+        }
+
+        ++since_commit;
+        if (commit_every_ > 0 && since_commit >= commit_every_) {
+          session_->Flush();
+          since_commit = 0;
+        }
+      }
+      session_->set_deferred_commit(false);
+      session_->Flush();
+
+      session_->out() << "Ran " << commands << " commands, " << failed << " failed.\n";
+      session_->set_result(failed == 0 ? 0 : -16);
+    }
+    catch (...)
+    {
+      session_->set_deferred_commit(false);
+      ExceptionHandler(session_);
+    }
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+int RunCommand(Session* session, const std::vector<std::string>& arguments) {
+  argparse::Parser parser("Finans command line client");
+
+  cmd_status status(session);
+  parser.AddSubParser("status", &status);
+  cmd_install install(session);
+  parser.AddSubParser("install", &install);
+  cmd_addcurrecy addcurr(session);
+  parser.AddSubParser("addcurrency", &addcurr);
+  cmd_addaccount addacc(session);
+  parser.AddSubParser("addaccount", &addacc);
+  cmd_addcompany addcom(session);
+  parser.AddSubParser("addcompany", &addcom);
+  cmd_addcategory addcat(session);
+  parser.AddSubParser("addcategory", &addcat);
+  cmd_addrate addrate(session);
+  parser.AddSubParser("addrate", &addrate);
+  cmd_networth networth(session);
+  parser.AddSubParser("networth", &networth);
+  cmd_list list(session);
+  parser.AddSubParser("list", &list);
+  cmd_query query(session);
+  parser.AddSubParser("query", &query);
+  cmd_balance balance(session);
+  parser.AddSubParser("balance", &balance);
+  cmd_report report(session);
+  parser.AddSubParser("report", &report);
+  cmd_import import(session);
+  parser.AddSubParser("import", &import);
+  cmd_export exp(session);
+  parser.AddSubParser("export", &exp);
+  cmd_convert convert(session);
+  parser.AddSubParser("convert", &convert);
+  cmd_serve serve(session);
+  parser.AddSubParser("serve", &serve);
+  cmd_batch batch(session);
+  parser.AddSubParser("batch", &batch);
+
+  session->set_result(0);
+  auto ret = parser.ParseArgs(argparse::Arguments("fin", arguments), session->out(), session->err());
+  if (ret == argparse::Parser::ParseFailed) return -1;
+  else return session->result();
+}
+
+bool ReadsInput(const std::vector<std::string>& arguments) {
+  // only batch reads the input, and only when not given a file
+  if (arguments.empty()) return false;
+  const auto command = ToLower(arguments[0]);
+  if (command.empty() || StartsWith("batch", command) == false) return false;
+  for (const auto& arg : arguments) {
+    if (arg == "--file") return false;
+  }
+  return true;
+}
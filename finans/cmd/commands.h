@@ -0,0 +1,62 @@
+// Copyright (2015) Gustav
+
+#ifndef CMD_COMMANDS_H_
+#define CMD_COMMANDS_H_
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Finans;
+class CommandServer;
+
+// what the commands run against, when running from the command line finans
+// is loaded for a single command, but a server keeps it between commands
+class Session {
+public:
+  Session(std::istream* in, std::ostream* out, std::ostream* err);
+
+  std::istream& in();
+  std::ostream& out();
+  std::ostream& err();
+  void set_streams(std::istream* in, std::ostream* out, std::ostream* err);
+
+  // loads finans on first use, and again if the files have been changed
+  // by someone else since
+  std::shared_ptr<Finans> GetFinans();
+  // call when finans has been modified
+  void Commit();
+  // forget the loaded finans, the next command will load it again
+  void Invalidate();
+
+  // when deferred, commits are only saved on Flush
+  bool deferred_commit() const;
+  void set_deferred_commit(bool deferred);
+  void Flush();
+
+  int result() const;
+  void set_result(int result);
+
+  // set while serving other processes
+  CommandServer* server();
+  void set_server(CommandServer* server);
+
+private:
+  std::istream* in_;
+  std::ostream* out_;
+  std::ostream* err_;
+  int result_;
+  bool deferred_commit_;
+  bool has_uncommitted_;
+  CommandServer* server_;
+  std::shared_ptr<Finans> finans_;
+};
+
+// parses and runs a single command line (without the app name), returns the exit code
+int RunCommand(Session* session, const std::vector<std::string>& arguments);
+
+// true if the command line will read from the standard input
+bool ReadsInput(const std::vector<std::string>& arguments);
+
+#endif  // CMD_COMMANDS_H_
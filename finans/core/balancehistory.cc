@@ -0,0 +1,162 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/balancehistory.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+std::size_t LowestBit(std::size_t i) {
+  return i & (~i + 1);
+}
+}  // namespace
+
+// the tree is 1 based, tree_[i-1] holds the sum of the values in (i - LowestBit(i), i]
+
+void BalanceHistory::Series::Add(int64_t when, int64_t value) {
+  if (whens.empty() || whens.back() <= when) {
+    whens.push_back(when);
+    values.push_back(value);
+    const auto i = whens.size();
+    tree_.push_back(value + Sum(i - 1) - Sum(i - LowestBit(i)));
+    return;
+  }
+
+  // after all the exchanges with the same time, like the time index
+  const auto position = std::upper_bound(whens.begin(), whens.end(), when) - whens.begin();
+  whens.insert(whens.begin() + position, when);
+  values.insert(values.begin() + position, value);
+  RebuildFrom(static_cast<std::size_t>(position));
+}
+
+void BalanceHistory::Series::AddAll(const std::vector<std::pair<int64_t, int64_t>>& entries) {
+  if (entries.empty()) return;
+  const auto old_size = whens.size();
+  const auto first = static_cast<std::size_t>(std::upper_bound(whens.begin(), whens.end(), entries.front().first) - whens.begin());
+
+  // merge from the back so only the changed part is moved, the old entries
+  // stay before new ones with the same time
+  whens.resize(old_size + entries.size());
+  values.resize(old_size + entries.size());
+  auto old_entry = old_size;
+  auto new_entry = entries.size();
+  for (auto target = whens.size(); new_entry > 0; --target) {
+    if (old_entry > first && whens[old_entry - 1] > entries[new_entry - 1].first) {
+      --old_entry;
+      whens[target - 1] = whens[old_entry];
+      values[target - 1] = values[old_entry];
+    }
+    else {
+      --new_entry;
+      whens[target - 1] = entries[new_entry].first;
+      values[target - 1] = entries[new_entry].second;
+    }
+  }
+  RebuildFrom(first);
+}
+
+int64_t BalanceHistory::Series::Sum(std::size_t count) const {
+  assert(count <= tree_.size());
+  int64_t sum = 0;
+  for (auto i = count; i > 0; i -= LowestBit(i)) {
+    sum += tree_[i - 1];
+  }
+  return sum;
+}
+
+std::size_t BalanceHistory::Series::CountBefore(int64_t time) const {
+  return static_cast<std::size_t>(std::lower_bound(whens.begin(), whens.end(), time) - whens.begin());
+}
+
+void BalanceHistory::Series::RebuildFrom(std::size_t first) {
+  tree_.resize(values.size());
+  if (first == 0) {
+    std::copy(values.begin(), values.end(), tree_.begin());
+    for (std::size_t i = 1; i <= tree_.size(); ++i) {
+      const auto parent = i + LowestBit(i);
+      if (parent <= tree_.size()) tree_[parent - 1] += tree_[i - 1];
+    }
+    return;
+  }
+
+  // every node is its value and the nodes below it, those below first are
+  // still valid and the rest are done in order
+  for (auto i = first + 1; i <= tree_.size(); ++i) {
+    auto sum = values[i - 1];
+    for (auto child = i - 1; child > i - LowestBit(i); child -= LowestBit(child)) {
+      sum += tree_[child - 1];
+    }
+    tree_[i - 1] = sum;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void BalanceHistory::Clear() {
+  accounts_.clear();
+}
+
+void BalanceHistory::Add(int account, int currency, int64_t when, int64_t value) {
+  assert(account >= 0);
+  if (static_cast<std::size_t>(account) >= accounts_.size()) {
+    accounts_.resize(account + 1);
+  }
+  accounts_[account][currency].Add(when, value);
+}
+
+int64_t BalanceHistory::GetBalanceBefore(int account, int currency, int64_t time) const {
+  const auto* series = Find(account, currency);
+  if (series == nullptr) return 0;
+  return series->Sum(series->CountBefore(time));
+}
+
+std::vector<int64_t> BalanceHistory::GetBalancesBefore(int account, int currency, const std::vector<int64_t>& times) const {
+  assert(std::is_sorted(times.begin(), times.end()));
+  std::vector<int64_t> ret;
+  ret.reserve(times.size());
+  const auto* series = Find(account, currency);
+  if (series == nullptr || times.empty()) {
+    ret.resize(times.size(), 0);
+    return ret;
+  }
+
+  // jump to the first time and walk from there
+  auto position = series->CountBefore(times.front());
+  auto sum = series->Sum(position);
+  for (const auto time : times) {
+    while (position < series->whens.size() && series->whens[position] < time) {
+      sum += series->values[position];
+      ++position;
+    }
+    ret.push_back(sum);
+  }
+  return ret;
+}
+
+void BalanceHistory::AddAll(const int* accounts, const int* currencies, const int64_t* whens, const int* values, std::size_t count) {
+  // group by series, the stable sort keeps the order of exchanges with the same time
+  std::map<std::pair<int, int>, std::vector<std::pair<int64_t, int64_t>>> series;
+  for (std::size_t i = 0; i < count; ++i) {
+    assert(accounts[i] >= 0);
+    series[std::make_pair(accounts[i], currencies[i])].push_back(std::make_pair(whens[i], static_cast<int64_t>(values[i])));
+  }
+  for (auto& s : series) {
+    auto& entries = s.second;
+    std::stable_sort(entries.begin(), entries.end(), [](const std::pair<int64_t, int64_t>& lhs, const std::pair<int64_t, int64_t>& rhs) {
+      return lhs.first < rhs.first;
+    });
+    const auto account = s.first.first;
+    if (static_cast<std::size_t>(account) >= accounts_.size()) {
+      accounts_.resize(account + 1);
+    }
+    accounts_[account][s.first.second].AddAll(entries);
+  }
+}
+
+const BalanceHistory::Series* BalanceHistory::Find(int account, int currency) const {
+  if (account < 0 || static_cast<std::size_t>(account) >= accounts_.size()) return nullptr;
+  const auto& currencies = accounts_[account];
+  const auto found = currencies.find(currency);
+  if (found == currencies.end()) return nullptr;
+  return &found->second;
+}
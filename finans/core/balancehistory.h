@@ -0,0 +1,58 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_BALANCEHISTORY_H_
+#define CORE_BALANCEHISTORY_H_
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+// the balance of each account and currency over time. every series is a
+// fenwick tree over its exchanges in when order, so the balance at any
+// point in time is O(log n)
+class BalanceHistory {
+public:
+  void Clear();
+
+  // exchanges are normally added in when order which is O(log n),
+  // adding a older exchange updates the part of the series after it
+  void Add(int account, int currency, int64_t when, int64_t value);
+
+  // adds a whole column of exchanges in any order, every series is merged
+  // and updated once instead of once per exchange
+  void AddAll(const int* accounts, const int* currencies, const int64_t* whens, const int* values, std::size_t count);
+
+  // the sum of all values where when < time
+  int64_t GetBalanceBefore(int account, int currency, int64_t time) const;
+
+  // GetBalanceBefore for each time, the times must be sorted.
+  // walks the series once, so O(n + times) instead of O(times log n)
+  std::vector<int64_t> GetBalancesBefore(int account, int currency, const std::vector<int64_t>& times) const;
+
+private:
+  class Series {
+  public:
+    void Add(int64_t when, int64_t value);
+    // the entries must be sorted by when
+    void AddAll(const std::vector<std::pair<int64_t, int64_t>>& entries);
+    // sum of the first count values
+    int64_t Sum(std::size_t count) const;
+    // number of values where when < time
+    std::size_t CountBefore(int64_t time) const;
+
+    std::vector<int64_t> whens;
+    std::vector<int64_t> values;
+
+  private:
+    // the tree for the values from first and on, the part before is unchanged
+    void RebuildFrom(std::size_t first);
+    std::vector<int64_t> tree_;
+  };
+
+  const Series* Find(int account, int currency) const;
+
+  std::vector<std::map<int, Series>> accounts_;
+};
+
+#endif  // CORE_BALANCEHISTORY_H_
@@ -0,0 +1,103 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/balances.h"
+
+#include <algorithm>
+#include <cassert>
+
+Balances::Balances() : accounts_(0), currencies_(0) {
+}
+
+void Balances::Clear() {
+  accounts_ = 0;
+  currencies_ = 0;
+  values_.clear();
+  used_.clear();
+}
+
+void Balances::Add(int account, int currency, int64_t value) {
+  assert(account >= 0 && currency >= 0);
+  if (account >= accounts_ || currency >= currencies_) {
+    Grow(std::max(accounts_, account + 1), std::max(currencies_, currency + 1));
+  }
+  const auto i = Index(account, currency);
+  values_[i] += value;
+  used_[i] = 1;
+}
+
+void Balances::AddAll(const int* accounts, const int* currencies, const int* values, std::size_t count) {
+  if (count == 0) return;
+  const auto max_account = *std::max_element(accounts, accounts + count);
+  const auto max_currency = *std::max_element(currencies, currencies + count);
+  assert(*std::min_element(accounts, accounts + count) >= 0);
+  assert(*std::min_element(currencies, currencies + count) >= 0);
+  Grow(std::max(accounts_, max_account + 1), std::max(currencies_, max_currency + 1));
+
+  auto* balance = values_.data();
+  auto* used = used_.data();
+  const auto stride = static_cast<std::size_t>(currencies_);
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto index = static_cast<std::size_t>(accounts[i]) * stride + currencies[i];
+    balance[index] += values[i];
+    used[index] = 1;
+  }
+}
+
+int64_t Balances::Get(int account, int currency) const {
+  if (account < 0 || account >= accounts_ || currency < 0 || currency >= currencies_) return 0;
+  return values_[Index(account, currency)];
+}
+
+std::vector<int> Balances::GetCurrencies(int account) const {
+  std::vector<int> ret;
+  if (account < 0 || account >= accounts_) return ret;
+  for (int currency = 0; currency < currencies_; ++currency) {
+    if (used_[Index(account, currency)]) ret.push_back(currency);
+  }
+  return ret;
+}
+
+bool Balances::operator==(const Balances& rhs) const {
+  // a missing account is the same as a account with only zero balances
+  const auto accounts = std::max(accounts_, rhs.accounts_);
+  const auto currencies = std::max(currencies_, rhs.currencies_);
+  for (int account = 0; account < accounts; ++account) {
+    for (int currency = 0; currency < currencies; ++currency) {
+      if (Get(account, currency) != rhs.Get(account, currency)) return false;
+    }
+  }
+  return true;
+}
+
+bool Balances::operator!=(const Balances& rhs) const {
+  return !(*this == rhs);
+}
+
+void Balances::Grow(int accounts, int currencies) {
+  if (accounts == accounts_ && currencies == currencies_) return;
+  if (currencies == currencies_) {
+    // same row size, the new accounts go at the end
+    values_.resize(static_cast<std::size_t>(accounts) * currencies, 0);
+    used_.resize(values_.size(), 0);
+    accounts_ = accounts;
+    return;
+  }
+
+  std::vector<int64_t> values(static_cast<std::size_t>(accounts) * currencies, 0);
+  std::vector<char> used(values.size(), 0);
+  for (int account = 0; account < accounts_; ++account) {
+    for (int currency = 0; currency < currencies_; ++currency) {
+      const auto to = static_cast<std::size_t>(account) * currencies + currency;
+      values[to] = values_[Index(account, currency)];
+      used[to] = used_[Index(account, currency)];
+    }
+  }
+  values_.swap(values);
+  used_.swap(used);
+  accounts_ = accounts;
+  currencies_ = currencies;
+}
+
+std::size_t Balances::Index(int account, int currency) const {
+  return static_cast<std::size_t>(account) * currencies_ + currency;
+}
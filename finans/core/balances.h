@@ -0,0 +1,44 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_BALANCES_H_
+#define CORE_BALANCES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// running balance per account and currency, in cents. every account has a
+// dense wallet indexed by currency so a update is a array lookup, there
+// are few currencies so the unused slots are cheap
+class Balances {
+public:
+  Balances();
+
+  void Clear();
+
+  void Add(int account, int currency, int64_t value);
+
+  // adds a whole column of exchanges, the wallets are grown once up front
+  void AddAll(const int* accounts, const int* currencies, const int* values, std::size_t count);
+
+  int64_t Get(int account, int currency) const;
+
+  // the currencies the account has a balance in, sorted
+  std::vector<int> GetCurrencies(int account) const;
+
+  bool operator==(const Balances& rhs) const;
+  bool operator!=(const Balances& rhs) const;
+
+private:
+  void Grow(int accounts, int currencies);
+  std::size_t Index(int account, int currency) const;
+
+  int accounts_;
+  int currencies_;
+  // accounts_ rows of currencies_ each
+  std::vector<int64_t> values_;
+  // if the currency has been used by the account, even if the balance is 0
+  std::vector<char> used_;
+};
+
+#endif  // CORE_BALANCES_H_
@@ -0,0 +1,95 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/batch.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "rapidjson/document.h"
+
+#include "finans/core/stringutils.h"
+
+namespace {
+// the shortest text that reads back as the same double, the way it would be
+// written on the command line, 10.5 and not 10.500000000000000
+std::string FormatDouble(double value) {
+  char buffer[32];
+  for (int precision = 15; precision <= 17; ++precision) {
+    snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+    if (std::strtod(buffer, nullptr) == value) break;
+  }
+  return buffer;
+}
+
+std::string ParseJsonLine(const std::string& line, std::vector<std::string>* arguments) {
+  rapidjson::Document doc;
+  doc.Parse<0>(line.c_str());
+  if (doc.HasParseError()) return "Invalid json";
+  if (doc.IsArray() == false) return "Expected a json array";
+
+  for (rapidjson::SizeType i = 0; i < doc.Size(); ++i) {
+    const auto& v = doc[i];
+    if (v.IsString()) {
+      arguments->push_back(std::string(v.GetString(), v.GetStringLength()));
+    }
+    else if (v.IsInt64()) {
+      arguments->push_back(std::to_string(v.GetInt64()));
+    }
+    else if (v.IsDouble()) {
+      arguments->push_back(FormatDouble(v.GetDouble()));
+    }
+    else {
+      return "Expected only strings and numbers in the json array";
+    }
+  }
+  return "";
+}
+
+std::string ParseCommandLine(const std::string& line, std::vector<std::string>* arguments) {
+  std::string current;
+  bool has_current = false;
+  char quote = 0;
+
+  for (std::size_t i = 0; i < line.size(); ++i) {
+    const char c = line[i];
+    if (quote == '\'') {
+      if (c == '\'') quote = 0;
+      else current += c;
+    }
+    else if (quote == '"') {
+      if (c == '"') quote = 0;
+      else if (c == '\\' && i + 1 < line.size()) current += line[++i];
+      else current += c;
+    }
+    else if (c == '"' || c == '\'') {
+      quote = c;
+      has_current = true;
+    }
+    else if (c == '\\' && i + 1 < line.size()) {
+      current += line[++i];
+      has_current = true;
+    }
+    else if (kSpaceCharacters.find(c) != std::string::npos) {
+      if (has_current) arguments->push_back(current);
+      current.clear();
+      has_current = false;
+    }
+    else {
+      current += c;
+      has_current = true;
+    }
+  }
+
+  if (quote != 0) return "Missing end quote";
+  if (has_current) arguments->push_back(current);
+  return "";
+}
+}  // namespace
+
+std::string ParseBatchLine(const std::string& line, std::vector<std::string>* arguments) {
+  arguments->clear();
+  const auto trimmed = Trim(line);
+  if (trimmed.empty() || trimmed[0] == '#') return "";
+  if (trimmed[0] == '[') return ParseJsonLine(trimmed, arguments);
+  return ParseCommandLine(trimmed, arguments);
+}
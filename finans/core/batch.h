@@ -0,0 +1,16 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_BATCH_H_
+#define CORE_BATCH_H_
+
+#include <string>
+#include <vector>
+
+// a line in a batch is either a command line that is split like a shell
+// would split it, or a json array of strings and numbers (json lines).
+// numbers are passed on as the text they would be typed as, ie. 10.5
+// empty lines and lines starting with # give no arguments.
+// returns a empty string on success
+std::string ParseBatchLine(const std::string& line, std::vector<std::string>* arguments);
+
+#endif  // CORE_BATCH_H_
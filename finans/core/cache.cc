@@ -0,0 +1,43 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/cache.h"
+
+#include "finans/core/file.h"
+#include "finans/core/proto.h"
+
+bool LoadLedgerCache(const std::string& cache, const std::string& source, finans::Finans* finans) {
+  int64_t size = 0;
+  int64_t modified = 0;
+  if (false == GetFileInfo(source, &size, &modified)) return false;
+  if (false == IsProtoBinary(cache)) return false;
+
+  finans::LedgerCache loaded;
+  if (LoadProtoBinary(&loaded, cache).empty() == false) return false;
+  if (loaded.source() != source) return false;
+  if (loaded.size() != size || loaded.modified() != modified) return false;
+
+  // size and time can match even though the file has been changed,
+  // hashing is still a lot cheaper than parsing the json
+  uint64_t hash = 0;
+  if (false == HashFile(source, &hash)) return false;
+  if (loaded.hash() != hash) return false;
+
+  finans->Swap(loaded.mutable_finans());
+  return true;
+}
+
+std::string SaveLedgerCache(const std::string& cache, const std::string& source, const finans::Finans& finans) {
+  finans::LedgerCache c;
+  int64_t size = 0;
+  int64_t modified = 0;
+  uint64_t hash = 0;
+  if (false == GetFileInfo(source, &size, &modified)) return "Unable to stat " + source;
+  if (false == HashFile(source, &hash)) return "Unable to hash " + source;
+
+  c.set_source(source);
+  c.set_size(size);
+  c.set_modified(modified);
+  c.set_hash(hash);
+  c.mutable_finans()->CopyFrom(finans);
+  return SaveProtoBinary(c, cache);
+}
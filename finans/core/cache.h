@@ -0,0 +1,19 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_CACHE_H_
+#define CORE_CACHE_H_
+
+#include <string>
+
+#include "finans/core/finans-proto.h"
+
+// the cache is a binary copy of a parsed json snapshot, it is only used when
+// the size, modification time and hash of the snapshot matches
+
+// returns true on a cache hit
+bool LoadLedgerCache(const std::string& cache, const std::string& source, finans::Finans* finans);
+
+// returns a empty string on success
+std::string SaveLedgerCache(const std::string& cache, const std::string& source, const finans::Finans& finans);
+
+#endif  // CORE_CACHE_H_
@@ -273,7 +273,7 @@ namespace argparse {
     }
     default:
       assert(false && "missing case");
-      throw "invalid count type in " __FUNCTION__;
+      throw "invalid count type in Help::GetMetavarReprestentation";
     }
   }
 
@@ -23,6 +23,11 @@ bool LoadConfiguration(finans::DeviceConfigutation* device) {
   else return false; // error
 }
 
+void SaveConfiguration(const finans::DeviceConfigutation& device) {
+  const auto result = SaveProtoJson(device, DevicePath());
+  if (result.empty() == false) throw "Unable to save configuration: " + result;
+}
+
 void InstallConfiguration(const std::string& finans_path, bool create_if_missing) {
   const auto path = DevicePath();
   finans::DeviceConfigutation device;
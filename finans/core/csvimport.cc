@@ -0,0 +1,253 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/csvimport.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <sstream>  // NOLINT this is how we use sstream
+#include <unordered_map>
+
+#include "finans/core/stringutils.h"
+#include "finans/core/threadpool.h"
+
+namespace {
+const std::size_t MAX_COLUMNS = 64;
+
+struct Chunk {
+  explicit Chunk(DateOrder order) : begin(nullptr), end(nullptr), dates(order, TimeZone::LOCAL), lines(0), error_line(-1) { }
+
+  const char* begin;
+  const char* end;
+
+  std::vector<CsvRow> rows;
+  // payee indices in the rows are local to the chunk until they are merged
+  std::vector<std::string> new_payees;
+  std::unordered_map<std::string, int> new_payee_index;
+  // the dates are parsed as a column when the chunk is split into rows
+  std::vector<StringRange> date_column;
+  std::vector<int> row_lines;
+  std::vector<int64_t> whens;
+  DateParser dates;
+
+  int lines;
+  int error_line;
+  std::string error;
+};
+
+StringRange Trim(StringRange r) {
+  while (r.begin != r.end && (*r.begin == ' ' || *r.begin == '\t' || *r.begin == '"')) ++r.begin;
+  while (r.end != r.begin && (r.end[-1] == ' ' || r.end[-1] == '\t' || r.end[-1] == '"' || r.end[-1] == '\r')) --r.end;
+  return r;
+}
+
+void ParseLine(const char* begin, const char* end, const CsvFormat& format, const NameIndex& companies,
+               const std::string& separators, StringRange* columns, Chunk* chunk) {
+  const auto count = Tokenize(begin, end, separators, false, columns, MAX_COLUMNS);
+  const auto needed = std::max(format.date_column, std::max(format.payee_column, format.amount_column));
+  if (count <= static_cast<std::size_t>(needed)) {
+    chunk->error = "Expected at least " + std::to_string(needed + 1) + " columns";
+    return;
+  }
+
+  CsvRow row;
+  row.when = 0;
+  const auto amount = Trim(columns[format.amount_column]);
+  if (false == ParseCents(amount.begin, amount.end, &row.value)) {
+    chunk->error = "Invalid amount " + amount.str();
+    return;
+  }
+
+  const auto payee = Trim(columns[format.payee_column]).str();
+  if (payee.empty()) {
+    chunk->error = "Missing payee";
+    return;
+  }
+  row.company = companies.Find(payee);
+  row.payee = -1;
+  if (row.company == -1) {
+    const auto key = ToLower(payee);
+    const auto found = chunk->new_payee_index.find(key);
+    if (found != chunk->new_payee_index.end()) {
+      row.payee = found->second;
+    }
+    else {
+      row.payee = static_cast<int>(chunk->new_payees.size());
+      chunk->new_payee_index[key] = row.payee;
+      chunk->new_payees.push_back(payee);
+    }
+  }
+  chunk->rows.push_back(row);
+  chunk->date_column.push_back(Trim(columns[format.date_column]));
+  chunk->row_lines.push_back(chunk->lines);
+}
+
+void ParseChunk(const CsvFormat& format, const NameIndex& companies, Chunk* chunk) {
+  const std::string separators(1, format.separator);
+  // the columns of the current line, reused for every line
+  StringRange columns[MAX_COLUMNS];
+  const char* line = chunk->begin;
+  while (line < chunk->end) {
+    const char* newline = static_cast<const char*>(memchr(line, '\n', chunk->end - line));
+    const char* end = newline ? newline : chunk->end;
+    const auto content = Trim(StringRange{ line, end });
+    if (content.size() > 0) {
+      ParseLine(line, end, format, companies, separators, columns, chunk);
+      if (chunk->error.empty() == false) {
+        chunk->error_line = chunk->lines;
+        break;
+      }
+    }
+    chunk->lines += 1;
+    line = end + 1;
+  }
+
+  chunk->whens.resize(chunk->rows.size());
+  const auto parsed = chunk->dates.ParseAll(chunk->date_column.data(), chunk->date_column.size(), chunk->whens.data());
+  if (parsed != chunk->date_column.size()) {
+    // the rows before a bad line are still parsed, the first error wins
+    if (chunk->error.empty() == false && chunk->error_line < chunk->row_lines[parsed]) return;
+    chunk->error = "Invalid date " + chunk->date_column[parsed].str();
+    chunk->error_line = chunk->row_lines[parsed];
+    return;
+  }
+  for (std::size_t i = 0; i < chunk->rows.size(); ++i) {
+    chunk->rows[i].when = chunk->whens[i];
+  }
+}
+
+// the start of the line after the position
+const char* NextLine(const char* position, const char* end) {
+  if (position >= end) return end;
+  const char* newline = static_cast<const char*>(memchr(position, '\n', end - position));
+  return newline ? newline + 1 : end;
+}
+}  // namespace
+
+CsvFormat::CsvFormat()
+  : separator(',')
+  , header(true)
+  , date_column(0)
+  , date_order(DateOrder::YEAR_MONTH_DAY)
+  , payee_column(1)
+  , amount_column(2) {
+}
+
+std::string ParseCsv(const char* data, std::size_t size, const CsvFormat& format,
+                     const NameIndex& companies, int threads, CsvImport* result) {
+  result->rows.clear();
+  result->new_payees.clear();
+  if (format.date_column < 0 || format.payee_column < 0 || format.amount_column < 0) return "Invalid column";
+  if (std::max(format.date_column, std::max(format.payee_column, format.amount_column)) >= static_cast<int>(MAX_COLUMNS)) {
+    return "Too many columns";
+  }
+
+  const char* end = data + size;
+  const char* start = format.header ? NextLine(data, end) : data;
+  const int first_line = format.header ? 2 : 1;
+
+  ThreadPool pool(threads);
+  // a few chunks per thread, but not so small the overhead dominates
+  const std::size_t min_chunk = 64 * 1024;
+  const auto bytes = static_cast<std::size_t>(end - start);
+  const auto chunk_count = std::max<std::size_t>(1, std::min<std::size_t>(pool.size() * 4, bytes / min_chunk));
+  std::vector<Chunk> chunks(chunk_count, Chunk(format.date_order));
+  const char* chunk_start = start;
+  for (std::size_t i = 0; i < chunk_count; ++i) {
+    chunks[i].begin = chunk_start;
+    chunks[i].end = i + 1 == chunk_count ? end : NextLine(start + bytes * (i + 1) / chunk_count, end);
+    chunks[i].end = std::max(chunks[i].end, chunk_start);
+    chunk_start = chunks[i].end;
+  }
+
+  for (auto& chunk : chunks) {
+    Chunk* c = &chunk;
+    pool.Add([&format, &companies, c]() { ParseChunk(format, companies, c); });
+  }
+  pool.Wait();
+
+  // merge in file order so the rows and new payees keep the order of the file
+  int line = first_line;
+  std::unordered_map<std::string, int> payees;
+  for (const auto& chunk : chunks) {
+    if (chunk.error.empty() == false) {
+      std::ostringstream ss;
+      ss << "line " << line + chunk.error_line << ": " << chunk.error;
+      return ss.str();
+    }
+    line += chunk.lines;
+  }
+  std::size_t total = 0;
+  for (const auto& chunk : chunks) {
+    total += chunk.rows.size();
+  }
+  result->rows.reserve(total);
+  for (const auto& chunk : chunks) {
+    std::vector<int> remap(chunk.new_payees.size());
+    for (std::size_t i = 0; i < chunk.new_payees.size(); ++i) {
+      const auto key = ToLower(chunk.new_payees[i]);
+      const auto found = payees.find(key);
+      if (found != payees.end()) {
+        remap[i] = found->second;
+      }
+      else {
+        remap[i] = static_cast<int>(result->new_payees.size());
+        payees[key] = remap[i];
+        result->new_payees.push_back(chunk.new_payees[i]);
+      }
+    }
+    for (auto row : chunk.rows) {
+      if (row.company == -1) row.payee = remap[row.payee];
+      result->rows.push_back(row);
+    }
+  }
+
+  return "";
+}
+
+bool ParseCents(const char* begin, const char* end, int* cents) {
+  if (begin == end) return false;
+  bool negative = false;
+  if (*begin == '-' || *begin == '+') {
+    negative = *begin == '-';
+    ++begin;
+  }
+
+  // the decimal point is the last . or , if it has 1 or 2 digits after it
+  const char* point = nullptr;
+  for (const char* c = end; c != begin; --c) {
+    if (c[-1] == '.' || c[-1] == ',') {
+      const auto decimals = end - c;
+      if (decimals == 1 || decimals == 2) point = c - 1;
+      break;
+    }
+  }
+
+  int64_t whole = 0;
+  bool any = false;
+  for (const char* c = begin; c != (point ? point : end); ++c) {
+    if (*c >= '0' && *c <= '9') {
+      whole = whole * 10 + (*c - '0');
+      any = true;
+      if (whole > std::numeric_limits<int>::max()) return false;
+    }
+    else if (*c != '.' && *c != ',' && *c != ' ') {
+      return false;
+    }
+  }
+  int fraction = 0;
+  if (point) {
+    for (const char* c = point + 1; c != end; ++c) {
+      if (*c < '0' || *c > '9') return false;
+      fraction = fraction * 10 + (*c - '0');
+      any = true;
+    }
+    if (end - point == 2) fraction *= 10;
+  }
+  if (any == false) return false;
+
+  const auto value = whole * 100 + fraction;
+  if (value > std::numeric_limits<int>::max()) return false;
+  *cents = static_cast<int>(negative ? -value : value);
+  return true;
+}
@@ -0,0 +1,52 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_CSVIMPORT_H_
+#define CORE_CSVIMPORT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "finans/core/dateparser.h"
+#include "finans/core/nameindex.h"
+
+// the layout of a bank statement, columns are 0 based.
+// fields can't contain the separator, even if they are quoted
+struct CsvFormat {
+  CsvFormat();
+
+  char separator;
+  // the first line is column names
+  bool header;
+  int date_column;
+  DateOrder date_order;
+  int payee_column;
+  int amount_column;  // ie. -1234.50, -1 234,50 or 1,234.50
+};
+
+struct CsvRow {
+  int64_t when;
+  int value;  // in cents
+  int company;  // -1 if the payee isn't a company yet
+  int payee;  // index into CsvImport::new_payees if company is -1
+};
+
+struct CsvImport {
+  // in file order
+  std::vector<CsvRow> rows;
+  // payees that aren't companies, in the order they were first seen
+  std::vector<std::string> new_payees;
+};
+
+// splits the statement in line aligned chunks that are parsed on threads,
+// below 1 uses all cores. payees are looked up in companies.
+// returns a error with the line number, or a empty string
+std::string ParseCsv(const char* data, std::size_t size, const CsvFormat& format,
+                     const NameIndex& companies, int threads, CsvImport* result);
+
+// the amount in cents, the last . or , followed by 1 or 2 digits is the
+// decimal point, other . , and spaces are thousand separators
+bool ParseCents(const char* begin, const char* end, int* cents);
+
+#endif  // CORE_CSVIMPORT_H_
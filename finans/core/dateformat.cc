@@ -0,0 +1,190 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/dateformat.h"
+
+#include <ctime>
+
+namespace {
+const int64_t SECONDS_PER_DAY = 24 * 60 * 60;
+
+const char DIGIT_PAIRS[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+char* WriteTwo(int value, char* dest) {
+  dest[0] = DIGIT_PAIRS[value * 2];
+  dest[1] = DIGIT_PAIRS[value * 2 + 1];
+  return dest + 2;
+}
+
+void AppendTwo(int value, std::string* out) {
+  char buffer[2];
+  WriteTwo(value, buffer);
+  out->append(buffer, 2);
+}
+
+void AppendYear(int64_t year, std::string* out) {
+  if (year < 0 || year > 9999) {
+    out->append(std::to_string(year));
+    return;
+  }
+  char buffer[4];
+  WriteTwo(static_cast<int>(year / 100), buffer);
+  WriteTwo(static_cast<int>(year % 100), buffer + 2);
+  out->append(buffer, 4);
+}
+}  // namespace
+
+DateFormat::DateFormat(const std::string& format) : layout_(Layout::GENERIC), needs_tm_(false) {
+  if (format == "%Y-%m-%d" || format == "%F") layout_ = Layout::DATE;
+  if (format == "%Y-%m-%d %H:%M:%S" || format == "%F %T") layout_ = Layout::DATE_TIME;
+
+  auto add = [this](PartType type, const std::string& text) {
+    if (type == PartType::TEXT && parts_.empty() == false && parts_.back().type == PartType::TEXT) {
+      parts_.back().text += text;
+      return;
+    }
+    parts_.push_back(Part{ type, text });
+  };
+
+  for (std::size_t i = 0; i < format.size(); ++i) {
+    if (format[i] != '%' || i + 1 == format.size()) {
+      add(PartType::TEXT, std::string(1, format[i]));
+      continue;
+    }
+    ++i;
+    switch (format[i]) {
+    case '%': add(PartType::TEXT, "%"); break;
+    case 'Y': add(PartType::YEAR, ""); break;
+    case 'y': add(PartType::SHORT_YEAR, ""); break;
+    case 'm': add(PartType::MONTH, ""); break;
+    case 'd': add(PartType::DAY, ""); break;
+    case 'H': add(PartType::HOUR, ""); break;
+    case 'M': add(PartType::MINUTE, ""); break;
+    case 'S': add(PartType::SECOND, ""); break;
+    case 'F':
+      add(PartType::YEAR, "");
+      add(PartType::TEXT, "-");
+      add(PartType::MONTH, "");
+      add(PartType::TEXT, "-");
+      add(PartType::DAY, "");
+      break;
+    case 'T':
+      add(PartType::HOUR, "");
+      add(PartType::TEXT, ":");
+      add(PartType::MINUTE, "");
+      add(PartType::TEXT, ":");
+      add(PartType::SECOND, "");
+      break;
+    default:
+      // modifiers like %Ey are part of the specifier
+      if ((format[i] == 'E' || format[i] == 'O') && i + 1 < format.size()) {
+        add(PartType::STRFTIME, format.substr(i - 1, 3));
+        ++i;
+      }
+      else {
+        add(PartType::STRFTIME, format.substr(i - 1, 2));
+      }
+      needs_tm_ = true;
+      break;
+    }
+  }
+}
+
+void DateFormat::AppendFields(const Fields& fields, const StructTmWrapper* time, std::string* out) const {
+  switch (layout_) {
+  case Layout::DATE:
+  case Layout::DATE_TIME:
+    if (fields.year >= 0 && fields.year <= 9999) {
+      char buffer[19];
+      char* c = WriteTwo(static_cast<int>(fields.year / 100), buffer);
+      c = WriteTwo(static_cast<int>(fields.year % 100), c);
+      *c++ = '-';
+      c = WriteTwo(fields.month, c);
+      *c++ = '-';
+      c = WriteTwo(fields.day, c);
+      if (layout_ == Layout::DATE_TIME) {
+        *c++ = ' ';
+        c = WriteTwo(fields.hour, c);
+        *c++ = ':';
+        c = WriteTwo(fields.minute, c);
+        *c++ = ':';
+        c = WriteTwo(fields.second, c);
+      }
+      out->append(buffer, c - buffer);
+      return;
+    }
+    break;
+  case Layout::GENERIC:
+    break;
+  }
+
+  for (const auto& part : parts_) {
+    switch (part.type) {
+    case PartType::TEXT: out->append(part.text); break;
+    case PartType::YEAR: AppendYear(fields.year, out); break;
+    case PartType::SHORT_YEAR: AppendTwo(static_cast<int>((fields.year % 100 + 100) % 100), out); break;
+    case PartType::MONTH: AppendTwo(fields.month, out); break;
+    case PartType::DAY: AppendTwo(fields.day, out); break;
+    case PartType::HOUR: AppendTwo(fields.hour, out); break;
+    case PartType::MINUTE: AppendTwo(fields.minute, out); break;
+    case PartType::SECOND: AppendTwo(fields.second, out); break;
+    case PartType::STRFTIME: {
+      if (time == nullptr) break;
+      const struct tm tt = time->time();
+      char buffer[128];
+      const auto written = strftime(buffer, sizeof(buffer), part.text.c_str(), &tt);
+      out->append(buffer, written);
+      break;
+    }
+    }
+  }
+}
+
+void DateFormat::Append(const StructTmWrapper& time, std::string* out) const {
+  const Fields fields = { time.year(), MonthToInt(time.month()) + 1, time.day_of_moth(), time.hour(), time.minutes(), time.seconds() };
+  AppendFields(fields, &time, out);
+}
+
+void DateFormat::AppendTime(int64_t local_seconds, const StructTmWrapper* time, std::string* out) const {
+  const auto days = civil::FloorDiv(local_seconds, SECONDS_PER_DAY);
+  const auto seconds = static_cast<int>(local_seconds - days * SECONDS_PER_DAY);
+  const auto date = CivilFromDays(days);
+  const Fields fields = { date.year, date.month, date.day, seconds / 3600, seconds / 60 % 60, seconds % 60 };
+  AppendFields(fields, time, out);
+}
+
+void DateFormat::AppendGmt(int64_t when, std::string* out) const {
+  if (needs_tm_) {
+    Append(Int64ToDateTime(static_cast<uint64_t>(when)).ToGmt(), out);
+    return;
+  }
+  AppendTime(when, nullptr, out);
+}
+
+void DateFormat::AppendLocal(int64_t when, UtcOffsetTable* local_time, std::string* out) const {
+  if (needs_tm_) {
+    // only the c library knows the names of the time zone and such
+    Append(Int64ToDateTime(static_cast<uint64_t>(when)).ToLocalTime(), out);
+    return;
+  }
+  AppendTime(when + local_time->Offset(when), nullptr, out);
+}
+
+void DateFormat::Append(Day day, std::string* out) const {
+  AppendGmt(day.GmtStart(), out);
+}
+
+std::string DateFormat::Format(const StructTmWrapper& time) const {
+  std::string out;
+  Append(time, &out);
+  return out;
+}
@@ -0,0 +1,64 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_DATEFORMAT_H_
+#define CORE_DATEFORMAT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "finans/core/datetime.h"
+#include "finans/core/day.h"
+
+// a strftime format parsed once, for printing many dates.
+// %Y %y %m %d %H %M %S %F %T and %% are written directly, %Y-%m-%d and
+// %Y-%m-%d %H:%M:%S have their own fast paths and everything else is
+// given to strftime one specifier at a time.
+// the append functions add to the end of out, so a caller can reuse one
+// buffer for a whole listing
+class DateFormat {
+public:
+  explicit DateFormat(const std::string& format);
+
+  void Append(const StructTmWrapper& time, std::string* out) const;
+  void AppendGmt(int64_t when, std::string* out) const;
+  void AppendLocal(int64_t when, UtcOffsetTable* local_time, std::string* out) const;
+  // midnight of the day
+  void Append(Day day, std::string* out) const;
+
+  std::string Format(const StructTmWrapper& time) const;
+
+private:
+  enum class Layout {
+    DATE, DATE_TIME, GENERIC
+  };
+
+  enum class PartType {
+    TEXT, YEAR, SHORT_YEAR, MONTH, DAY, HOUR, MINUTE, SECOND, STRFTIME
+  };
+
+  struct Part {
+    PartType type;
+    // the text, or the specifier for strftime
+    std::string text;
+  };
+
+  struct Fields {
+    int64_t year;
+    int month;
+    int day;
+    int hour;
+    int minute;
+    int second;
+  };
+
+  void AppendFields(const Fields& fields, const StructTmWrapper* time, std::string* out) const;
+  void AppendTime(int64_t local_seconds, const StructTmWrapper* time, std::string* out) const;
+
+  Layout layout_;
+  std::vector<Part> parts_;
+  // if any specifier needs strftime, and with that the struct tm
+  bool needs_tm_;
+};
+
+#endif  // CORE_DATEFORMAT_H_
@@ -0,0 +1,123 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/dateparser.h"
+
+namespace {
+const int64_t SECONDS_PER_DAY = 24 * 60 * 60;
+
+// count digits, moves begin past them
+bool ReadNumber(const char** begin, const char* end, int min_digits, int max_digits, int* value) {
+  int v = 0;
+  int digits = 0;
+  const char* c = *begin;
+  while (c != end && digits < max_digits && *c >= '0' && *c <= '9') {
+    v = v * 10 + (*c - '0');
+    ++c;
+    ++digits;
+  }
+  if (digits < min_digits) return false;
+  *begin = c;
+  *value = v;
+  return true;
+}
+
+bool IsSeparator(char c) {
+  return c == '-' || c == '/' || c == '.';
+}
+
+// the separator must be the same both times
+bool ReadSeparator(const char** begin, const char* end, char* separator) {
+  if (*begin == end || IsSeparator(**begin) == false) return false;
+  if (*separator != 0 && **begin != *separator) return false;
+  *separator = **begin;
+  ++*begin;
+  return true;
+}
+
+bool ParseTime(const char* c, const char* end, int* seconds) {
+  *seconds = 0;
+  if (c == end) return true;
+  if (*c != 'T' && *c != ' ') return false;
+  ++c;
+  int hour = 0;
+  int minute = 0;
+  int second = 0;
+  if (!ReadNumber(&c, end, 2, 2, &hour) || c == end || *c != ':') return false;
+  ++c;
+  if (!ReadNumber(&c, end, 2, 2, &minute)) return false;
+  if (c != end) {
+    if (*c != ':') return false;
+    ++c;
+    if (!ReadNumber(&c, end, 2, 2, &second)) return false;
+  }
+  if (c != end || hour > 23 || minute > 59 || second > 59) return false;
+  *seconds = hour * 3600 + minute * 60 + second;
+  return true;
+}
+}  // namespace
+
+bool ParseDate(const char* begin, const char* end, DateOrder order, ParsedDate* date) {
+  const char* c = begin;
+  char separator = 0;
+  int a = 0;
+  int b = 0;
+  int year = 0;
+  switch (order) {
+  case DateOrder::YEAR_MONTH_DAY:
+    if (!ReadNumber(&c, end, 4, 4, &year)) return false;
+    if (c != end && IsSeparator(*c)) {
+      if (!ReadSeparator(&c, end, &separator) || !ReadNumber(&c, end, 1, 2, &a) ||
+          !ReadSeparator(&c, end, &separator) || !ReadNumber(&c, end, 1, 2, &b)) {
+        return false;
+      }
+    }
+    else if (!ReadNumber(&c, end, 2, 2, &a) || !ReadNumber(&c, end, 2, 2, &b)) {
+      return false;
+    }
+    date->month = a;
+    date->day = b;
+    break;
+  case DateOrder::DAY_MONTH_YEAR:
+  case DateOrder::MONTH_DAY_YEAR:
+    if (!ReadNumber(&c, end, 1, 2, &a) || !ReadSeparator(&c, end, &separator) ||
+        !ReadNumber(&c, end, 1, 2, &b) || !ReadSeparator(&c, end, &separator) ||
+        !ReadNumber(&c, end, 4, 4, &year)) {
+      return false;
+    }
+    date->day = order == DateOrder::DAY_MONTH_YEAR ? a : b;
+    date->month = order == DateOrder::DAY_MONTH_YEAR ? b : a;
+    break;
+  }
+  date->year = year;
+  if (date->month < 1 || date->month > 12) return false;
+  if (date->day < 1 || date->day > DaysInMonth(date->year, date->month)) return false;
+  return ParseTime(c, end, &date->seconds);
+}
+
+DateParser::DateParser(DateOrder order, TimeZone timezone) : order_(order), timezone_(timezone) {
+}
+
+int64_t DateParser::Midnight(const ParsedDate& date) {
+  const auto days = DaysFromCivil(date.year, date.month, date.day);
+  if (timezone_ == TimeZone::GMT) return days * SECONDS_PER_DAY;
+  return local_time_.Midnight(days);
+}
+
+bool DateParser::Parse(const char* begin, const char* end, int64_t* when) {
+  ParsedDate date;
+  if (false == ParseDate(begin, end, order_, &date)) return false;
+  if (timezone_ == TimeZone::GMT || date.seconds == 0) {
+    *when = Midnight(date) + date.seconds;
+    return true;
+  }
+  // the offset can change during the day, so a time uses its own offset
+  *when = local_time_.FromLocal(DaysFromCivil(date.year, date.month, date.day) * SECONDS_PER_DAY + date.seconds);
+  return true;
+}
+
+std::size_t DateParser::ParseAll(const StringRange* dates, std::size_t count, int64_t* whens) {
+  for (std::size_t i = 0; i < count; ++i) {
+    if (false == Parse(dates[i].begin, dates[i].end, &whens[i])) return i;
+  }
+  return count;
+}
@@ -0,0 +1,54 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_DATEPARSER_H_
+#define CORE_DATEPARSER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "finans/core/datetime.h"
+#include "finans/core/stringutils.h"
+
+// the order of the date parts, the separators are - / or .
+enum class DateOrder {
+  // YYYY-MM-DD or YYYYMMDD
+  YEAR_MONTH_DAY,
+  // DD/MM/YYYY
+  DAY_MONTH_YEAR,
+  // MM/DD/YYYY
+  MONTH_DAY_YEAR
+};
+
+struct ParsedDate {
+  int year;
+  int month;  // 1 based
+  int day;
+  int seconds;  // since midnight
+};
+
+// a date optionally followed by a T or space and HH:MM or HH:MM:SS, doesn't allocate
+bool ParseDate(const char* begin, const char* end, DateOrder order, ParsedDate* date);
+
+// parses dates directly to seconds since the epoch like ExternalExchange.when.
+// gmt is plain arithmetic, local time only asks the c library the first
+// time a day is seen so a parser should be reused for a whole column.
+// not thread safe, every worker needs its own parser
+class DateParser {
+public:
+  DateParser(DateOrder order, TimeZone timezone);
+
+  bool Parse(const char* begin, const char* end, int64_t* when);
+
+  // a column of dates, returns the number of dates parsed so a index below
+  // count is the date that failed
+  std::size_t ParseAll(const StringRange* dates, std::size_t count, int64_t* whens);
+
+private:
+  int64_t Midnight(const ParsedDate& date);
+
+  DateOrder order_;
+  TimeZone timezone_;
+  UtcOffsetTable local_time_;
+};
+
+#endif  // CORE_DATEPARSER_H_
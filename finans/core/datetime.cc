@@ -4,6 +4,14 @@
 
 #include <vector>
 #include <cassert>
+#include <cstring>
+#include <limits>
+
+#include "finans/core/dateformat.h"
+
+namespace {
+const int64_t SECONDS_PER_DAY = 24 * 60 * 60;
+}  // namespace
 
 int MonthToInt(Month month) {
   return static_cast<int>(month);
@@ -25,13 +33,12 @@ TimetWrapper TimetWrapper::FromLocalTime(const StructTmWrapper& dt) {
 }
 
 TimetWrapper TimetWrapper::FromGmt(const StructTmWrapper& dt) {
-  // http://stackoverflow.com/questions/283166/easy-way-to-convert-a-struct-tm-expressed-in-utc-to-time-t-type
-#ifdef FINANS_WINDOWS
-  struct tm tt = dt.time();
-  return TimetWrapper(_mkgmtime(&tt));
-#else
-#error "undefined platform"
-#endif
+  // like mktime the fields may be out of range, day 32 is in the next month
+  const struct tm tt = dt.time();
+  const int64_t year = tt.tm_year + 1900 + civil::FloorDiv(tt.tm_mon, 12);
+  const int month = static_cast<int>(tt.tm_mon - civil::FloorDiv(tt.tm_mon, 12) * 12);
+  const int64_t days = DaysFromCivil(static_cast<int>(year), month + 1, 1) + tt.tm_mday - 1;
+  return TimetWrapper(static_cast<time_t>(days * SECONDS_PER_DAY + tt.tm_hour * 3600 + tt.tm_min * 60 + tt.tm_sec));
 }
 
 TimetWrapper TimetWrapper::CurrentTime() {
@@ -43,11 +50,35 @@ double TimetWrapper::Difference(const TimetWrapper& start, const TimetWrapper& e
 }
 
 StructTmWrapper TimetWrapper::ToLocalTime() const {
-  return StructTmWrapper(*localtime(&time_));
+  // localtime returns a shared buffer, use the reentrant versions so
+  // workers can convert times at the same time
+  struct tm tt;
+#ifdef FINANS_WINDOWS
+  localtime_s(&tt, &time_);
+#else
+  localtime_r(&time_, &tt);
+#endif
+  return StructTmWrapper(tt);
 }
 
 StructTmWrapper TimetWrapper::ToGmt() const {
-  return StructTmWrapper(*gmtime(&time_));
+  const int64_t time = static_cast<int64_t>(time_);
+  const int64_t days = civil::FloorDiv(time, SECONDS_PER_DAY);
+  const int seconds = static_cast<int>(time - days * SECONDS_PER_DAY);
+  const auto date = CivilFromDays(days);
+
+  struct tm tt = tm();
+  tt.tm_year = date.year - 1900;
+  tt.tm_mon = date.month - 1;
+  tt.tm_mday = date.day;
+  tt.tm_hour = seconds / 3600;
+  tt.tm_min = seconds / 60 % 60;
+  tt.tm_sec = seconds % 60;
+  // 1970-01-01 was a thursday
+  tt.tm_wday = static_cast<int>(days + 4 - civil::FloorDiv(days + 4, 7) * 7);
+  tt.tm_yday = static_cast<int>(days - DaysFromCivil(date.year, 1, 1));
+  tt.tm_isdst = 0;
+  return StructTmWrapper(tt);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -126,16 +157,7 @@ DstInfo StructTmWrapper::dst() const {
 }
 
 std::string StructTmWrapper::ToString(const std::string& format) const {
-  std::vector<char> ret;
-  const size_t base_size = 100;
-  for (int i = 1; i < 100; ++i) {
-    const size_t string_length = base_size * i;
-    ret.resize(string_length);
-    const auto characters_written = strftime(&ret[0], string_length, format.c_str(), &time_);
-    if (characters_written != 0) return &ret[0];
-  }
-
-  return "";
+  return DateFormat(format).Format(*this);
 }
 
 std::string StructTmWrapper::DebugString() const {
@@ -158,17 +180,13 @@ tm_wday	int	days since Sunday	0 - 6
 tm_yday	int	days since January 1	0 - 365
 */
 
+// time_t is seconds since 1970-01-01 utc on every platform we build on
 uint64_t DateTimeToInt64(const TimetWrapper& dt) {
-  const auto diff = TimetWrapper::Difference(TimetWrapper::FromGmt(StructTmWrapper(1970, Month::JANUARY ,1, 0, 0, 0)), dt);
-  return static_cast<uint64_t>(diff);
+  return static_cast<uint64_t>(static_cast<int64_t>(dt.time_));
 }
 
 TimetWrapper Int64ToDateTime(uint64_t i) {
-  const uint64_t minutes = (i - (i % 60)) / 60;
-  const int actual_seconds = i % 60;
-  const uint64_t hours = (minutes - (minutes % 60)) / 60;
-  const int acutal_minutes = minutes % 60;
-  return TimetWrapper::FromGmt(StructTmWrapper(1970, Month::JANUARY, 1, hours, acutal_minutes, actual_seconds));
+  return TimetWrapper(static_cast<time_t>(static_cast<int64_t>(i)));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -307,3 +325,92 @@ StructTmWrapper DateTime::AsStruct() const {
 void DateTime::UpdateTime(const StructTmWrapper& s) {
   time_ = ToTimetWrapper(s, timezone_);
 }
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace {
+// the entry for index, the table grows in the direction needed
+template<typename T>
+T& TableEntry(std::vector<T>* table, int64_t* first, int64_t index, const T& empty) {
+  if (table->empty()) {
+    *first = index;
+  }
+  if (index < *first) {
+    table->insert(table->begin(), static_cast<std::size_t>(*first - index), empty);
+    *first = index;
+  }
+  if (index >= *first + static_cast<int64_t>(table->size())) {
+    table->resize(static_cast<std::size_t>(index - *first + 1), empty);
+  }
+  return (*table)[static_cast<std::size_t>(index - *first)];
+}
+
+int LocalOffset(int64_t when) {
+  const auto local = Int64ToDateTime(static_cast<uint64_t>(when)).ToLocalTime();
+  const auto days = DaysFromCivil(local.year(), MonthToInt(local.month()) + 1, local.day_of_moth());
+  const auto seconds = days * SECONDS_PER_DAY + local.hour() * 3600 + local.minutes() * 60 + local.seconds();
+  return static_cast<int>(seconds - when);
+}
+
+const int64_t UNKNOWN_MIDNIGHT = std::numeric_limits<int64_t>::min();
+}  // namespace
+
+UtcOffsetTable::UtcOffsetTable() : first_(0), first_midnight_(0) {
+}
+
+UtcOffsetTable::Day& UtcOffsetTable::GetDay(int64_t utc_day) {
+  const Day unknown = { 0, 0, 0, false };
+  auto& day = TableEntry(&days_, &first_, utc_day, unknown);
+  if (day.known) return day;
+
+  const auto start = utc_day * SECONDS_PER_DAY;
+  const auto end = start + SECONDS_PER_DAY - 1;
+  day.before = LocalOffset(start);
+  day.after = LocalOffset(end);
+  day.change = start + SECONDS_PER_DAY;
+  if (day.before != day.after) {
+    // the first second with the new offset
+    int64_t low = start;
+    int64_t high = end;
+    while (high - low > 1) {
+      const auto middle = low + (high - low) / 2;
+      if (LocalOffset(middle) == day.before) low = middle;
+      else high = middle;
+    }
+    day.change = high;
+  }
+  day.known = true;
+  return day;
+}
+
+int UtcOffsetTable::Offset(int64_t when) {
+  const auto& day = GetDay(civil::FloorDiv(when, SECONDS_PER_DAY));
+  return when < day.change ? day.before : day.after;
+}
+
+int64_t UtcOffsetTable::LocalDay(int64_t when) {
+  return civil::FloorDiv(when + Offset(when), SECONDS_PER_DAY);
+}
+
+CivilDate UtcOffsetTable::LocalDate(int64_t when) {
+  return CivilFromDays(LocalDay(when));
+}
+
+int64_t UtcOffsetTable::FromLocal(int64_t local_seconds) {
+  // guess with the offset at the local seconds read as utc, then settle on
+  // the offset of the result. the second pass handles times near a change
+  auto when = local_seconds - Offset(local_seconds);
+  when = local_seconds - Offset(when);
+  return local_seconds - Offset(when);
+}
+
+int64_t UtcOffsetTable::Midnight(int64_t local_day) {
+  auto& midnight = TableEntry(&midnights_, &first_midnight_, local_day, UNKNOWN_MIDNIGHT);
+  if (midnight == UNKNOWN_MIDNIGHT) midnight = FromLocal(local_day * SECONDS_PER_DAY);
+  return midnight;
+}
+
+int64_t UtcOffsetTable::MonthStart(int64_t when) {
+  const auto date = LocalDate(when);
+  return Midnight(DaysFromCivil(date.year, date.month, 1));
+}
@@ -6,17 +6,25 @@
 #include <ctime>
 #include <string>
 #include <cstdint>
+#include <vector>
 
 class TimetWrapper;
 class StructTmWrapper;
+class DateFormat;
 
 enum class Month {
   JANUARY, FEBRUARY, MARCH, APRIL, MAY, JUNE, JULY, AUGUST, SEPTEMBER, OCTOBER, NOVEMBER, DECEMBER
 };
 
+// 0 based, january is 0
+int MonthToInt(Month month);
+Month IntToMonth(int m);
+
 class TimetWrapper {
 protected:
   friend class StructTmWrapper;
+  friend uint64_t DateTimeToInt64(const TimetWrapper& dt);
+  friend TimetWrapper Int64ToDateTime(uint64_t i);
   explicit TimetWrapper(time_t time);
 public:
   static TimetWrapper FromLocalTime(const StructTmWrapper& dt);
@@ -38,6 +46,7 @@ enum class DstInfo {
 class StructTmWrapper {
 protected:
   friend class TimetWrapper;
+  friend class DateFormat;
   explicit StructTmWrapper(struct tm time);
   struct tm time() const;
 
@@ -62,6 +71,7 @@ public:
   DstInfo dst() const;
 
   // format: http://www.cplusplus.com/reference/ctime/strftime/
+  // use a DateFormat when formatting many dates
   std::string ToString(const std::string& format) const;
   std::string DebugString() const;
 
@@ -74,12 +84,82 @@ private:
 uint64_t DateTimeToInt64(const TimetWrapper& dt);
 TimetWrapper Int64ToDateTime(uint64_t i);
 
+// a date in the gregorian calendar, month is 1 based
+struct CivilDate {
+  int year;
+  int month;
+  int day;
+};
+
+// the civil date functions are plain arithmetic and never touch the c time
+// functions, http://howardhinnant.github.io/date_algorithms.html
+// they are single expressions so they stay constexpr in c++11
+namespace civil {
+constexpr int64_t FloorDiv(int64_t a, int64_t b) {
+  return (a >= 0 ? a : a - b + 1) / b;
+}
+
+// the year starts in march so the leap day is the last day of the year
+constexpr int64_t DaysFromEra(int64_t era, int64_t year_of_era, int64_t day_of_year) {
+  return era * 146097 + year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year - 719468;
+}
+
+constexpr int64_t DaysFromMarchYear(int64_t year, int month, int day) {
+  return DaysFromEra(FloorDiv(year, 400), year - FloorDiv(year, 400) * 400,
+                     (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1);
+}
+
+constexpr int MonthFromMarchMonth(int64_t march_month) {
+  return static_cast<int>(march_month < 10 ? march_month + 3 : march_month - 9);
+}
+
+constexpr CivilDate FromDayOfYear(int64_t year, int64_t day_of_year, int64_t march_month) {
+  return CivilDate{ static_cast<int>(year + (MonthFromMarchMonth(march_month) <= 2 ? 1 : 0)),
+                    MonthFromMarchMonth(march_month),
+                    static_cast<int>(day_of_year - (153 * march_month + 2) / 5 + 1) };
+}
+
+constexpr CivilDate FromYearOfEra(int64_t era, int64_t day_of_era, int64_t year_of_era) {
+  return FromDayOfYear(year_of_era + era * 400,
+                       day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100),
+                       (5 * (day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100)) + 2) / 153);
+}
+
+constexpr CivilDate FromDayOfEra(int64_t era, int64_t day_of_era) {
+  return FromYearOfEra(era, day_of_era, (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365);
+}
+
+constexpr CivilDate FromShiftedDays(int64_t days) {
+  return FromDayOfEra(FloorDiv(days, 146097), days - FloorDiv(days, 146097) * 146097);
+}
+}  // namespace civil
+
+// days since 1970-01-01, month is 1 based
+constexpr int64_t DaysFromCivil(int year, int month, int day) {
+  return civil::DaysFromMarchYear(month <= 2 ? static_cast<int64_t>(year) - 1 : year, month, day);
+}
+
+constexpr CivilDate CivilFromDays(int64_t days) {
+  return civil::FromShiftedDays(days + 719468);
+}
+
+constexpr bool IsLeapYear(int year) {
+  return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+}
+
+// month is 1 based
+constexpr int DaysInMonth(int year, int month) {
+  return month == 2 ? (IsLeapYear(year) ? 29 : 28) : (month == 4 || month == 6 || month == 9 || month == 11) ? 30 : 31;
+}
+
 enum class TimeZone {
   GMT, LOCAL
 };
 
 // public interface
-// util class to make stuff nice to use
+// util class to make stuff nice to use.
+// safe to use from several threads, gmt is plain arithmetic and local time
+// uses the reentrant c functions
 class DateTime {
 public:
   static DateTime FromDate(int year, Month month, int day, TimeZone timezone = TimeZone::LOCAL);
@@ -125,4 +205,46 @@ private:
   TimetWrapper time_;
 };
 
+// converts between utc and local time without the c time functions once a
+// day has been seen. the offset is looked up per utc day and days where it
+// changes (daylight saving) remember the second it changes.
+// not thread safe, give every worker its own table
+class UtcOffsetTable {
+public:
+  UtcOffsetTable();
+
+  // seconds to add to when to get the local time
+  int Offset(int64_t when);
+
+  // days since 1970-01-01 in local time
+  int64_t LocalDay(int64_t when);
+  CivilDate LocalDate(int64_t when);
+
+  // the when of a local time given as seconds since 1970-01-01 local time,
+  // using the offset of that time like mktime and not the one of the day
+  int64_t FromLocal(int64_t local_seconds);
+  // the when of the local midnight that starts the day
+  int64_t Midnight(int64_t local_day);
+  // the local midnight that starts the month of when
+  int64_t MonthStart(int64_t when);
+
+private:
+  struct Day {
+    // the offset changes to after at the second change, change is past the
+    // end of the day if it doesn't
+    int64_t change;
+    int before;
+    int after;
+    bool known;
+  };
+
+  Day& GetDay(int64_t utc_day);
+
+  // both tables start at first_ and grow in both directions
+  int64_t first_;
+  std::vector<Day> days_;
+  int64_t first_midnight_;
+  std::vector<int64_t> midnights_;
+};
+
 #endif  // CORE_PROTO_H_
@@ -0,0 +1,41 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/day.h"
+
+#include <algorithm>
+
+#include "finans/core/kernels.h"
+
+Day Day::FromLocal(int64_t when, UtcOffsetTable* local_time) {
+  return Day(static_cast<int32_t>(local_time->LocalDay(when)));
+}
+
+Day Day::FromDateTime(const DateTime& dt) {
+  return FromCivil(dt.year(), MonthToInt(dt.month()) + 1, dt.day_of_moth());
+}
+
+int64_t Day::LocalStart(UtcOffsetTable* local_time) const {
+  return local_time->Midnight(days_);
+}
+
+DateTime Day::ToDateTime(TimeZone timezone) const {
+  const auto date = civil();
+  return DateTime::FromDateTime(date.year, IntToMonth(date.month - 1), date.day, 0, 0, 0, timezone);
+}
+
+void GmtDays(const int64_t* whens, std::size_t count, int32_t* days) {
+  SecondsToDays(whens, count, days);
+}
+
+void LocalDays(const int64_t* whens, std::size_t count, UtcOffsetTable* local_time, int32_t* days) {
+  // shift to local seconds a block at a time so the block stays in the cache
+  const std::size_t block = 1024;
+  int64_t local[block];
+  for (std::size_t start = 0; start < count; start += block) {
+    const auto size = std::min(block, count - start);
+    for (std::size_t i = 0; i < size; ++i) {
+      local[i] = whens[start + i] + local_time->Offset(whens[start + i]);
+    }
+    SecondsToDays(local, size, days + start);
+  }
+}
@@ -0,0 +1,91 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_DAY_H_
+#define CORE_DAY_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "finans/core/datetime.h"
+
+// iso order, the week starts on monday
+enum class Weekday {
+  MONDAY, TUESDAY, WEDNESDAY, THURSDAY, FRIDAY, SATURDAY, SUNDAY
+};
+
+// a date as the number of days since 1970-01-01, for grouping exchanges by
+// day, week and month and for stepping over days. the fields are computed
+// with arithmetic, not the c time functions
+class Day {
+public:
+  constexpr Day() : days_(0) { }
+  constexpr explicit Day(int32_t days) : days_(days) { }
+
+  // month is 1 based
+  static constexpr Day FromCivil(int year, int month, int day) {
+    return Day(static_cast<int32_t>(DaysFromCivil(year, month, day)));
+  }
+  // the utc day of a when
+  static constexpr Day FromGmt(int64_t when) {
+    return Day(static_cast<int32_t>(civil::FloorDiv(when, 24 * 60 * 60)));
+  }
+  // the local day of a when
+  static Day FromLocal(int64_t when, UtcOffsetTable* local_time);
+  // the day in the time zone of the date time
+  static Day FromDateTime(const DateTime& dt);
+
+  constexpr int32_t days() const { return days_; }
+  constexpr CivilDate civil() const { return CivilFromDays(days_); }
+  constexpr int year() const { return civil().year; }
+  // 1 based
+  constexpr int month() const { return civil().month; }
+  constexpr int day() const { return civil().day; }
+
+  constexpr Weekday weekday() const {
+    // 1970-01-01 was a thursday
+    return static_cast<Weekday>(civil::FloorDiv(days_ + 3, 7) * -7 + days_ + 3);
+  }
+  // the iso 8601 week, 1 to 53. the first week of the year has its
+  // thursday in the year, so the week of a day can belong to the year before or after
+  constexpr int IsoWeek() const {
+    return static_cast<int>((Thursday() - Day::FromCivil(Thursday().year(), 1, 1)) / 7 + 1);
+  }
+  constexpr int IsoWeekYear() const { return Thursday().year(); }
+
+  constexpr Day MonthStart() const { return FromCivil(year(), month(), 1); }
+  // the last day of the month
+  constexpr Day MonthEnd() const { return FromCivil(year(), month(), DaysInMonth(year(), month())); }
+
+  // seconds since the epoch of the start of the day
+  constexpr int64_t GmtStart() const { return static_cast<int64_t>(days_) * 24 * 60 * 60; }
+  // the local midnight, the same as DateTime for the date
+  int64_t LocalStart(UtcOffsetTable* local_time) const;
+  // midnight in the time zone
+  DateTime ToDateTime(TimeZone timezone = TimeZone::LOCAL) const;
+
+  constexpr Day operator+(int days) const { return Day(days_ + days); }
+  constexpr Day operator-(int days) const { return Day(days_ - days); }
+  constexpr int operator-(const Day& rhs) const { return days_ - rhs.days_; }
+  Day& operator+=(int days) { days_ += days; return *this; }
+
+  constexpr bool operator==(const Day& rhs) const { return days_ == rhs.days_; }
+  constexpr bool operator!=(const Day& rhs) const { return days_ != rhs.days_; }
+  constexpr bool operator<(const Day& rhs) const { return days_ < rhs.days_; }
+  constexpr bool operator<=(const Day& rhs) const { return days_ <= rhs.days_; }
+  constexpr bool operator>(const Day& rhs) const { return days_ > rhs.days_; }
+  constexpr bool operator>=(const Day& rhs) const { return days_ >= rhs.days_; }
+
+private:
+  constexpr Day Thursday() const { return *this + (3 - static_cast<int>(weekday())); }
+
+  int32_t days_;
+};
+
+// whole when columns, days[i] is Day::FromGmt(whens[i]).days() computed with
+// the simd kernels
+void GmtDays(const int64_t* whens, std::size_t count, int32_t* days);
+// days[i] is Day::FromLocal(whens[i]).days(), the offsets are looked up and the
+// division is done with the simd kernels
+void LocalDays(const int64_t* whens, std::size_t count, UtcOffsetTable* local_time, int32_t* days);
+
+#endif  // CORE_DAY_H_
@@ -0,0 +1,68 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/envelopes.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+// month, category and currency packed into one key, 20 bits each is plenty
+// and the order of the keys is the order of the rows
+const int KEY_BITS = 20;
+const uint64_t KEY_MASK = (1u << KEY_BITS) - 1;
+
+uint64_t MakeKey(int month, int category, int currency) {
+  assert(month >= 0 && static_cast<uint64_t>(month) <= KEY_MASK);
+  assert(category >= -1 && static_cast<uint64_t>(category + 1) <= KEY_MASK);
+  assert(currency >= 0 && static_cast<uint64_t>(currency) <= KEY_MASK);
+  return (static_cast<uint64_t>(month) << (2 * KEY_BITS)) |
+    (static_cast<uint64_t>(category + 1) << KEY_BITS) |
+    static_cast<uint64_t>(currency);
+}
+}  // namespace
+
+int FindMonth(const std::vector<int64_t>& months, int64_t when) {
+  assert(months.empty() == false);
+  const auto after = std::upper_bound(months.begin(), months.end(), when) - months.begin();
+  return after == 0 ? 0 : static_cast<int>(after - 1);
+}
+
+EnvelopeAccumulator::Sum::Sum() : sum(0), count(0) {
+}
+
+void EnvelopeAccumulator::Add(int month, int category, int currency, int64_t value) {
+  auto& s = sums_[MakeKey(month, category, currency)];
+  s.sum += value;
+  s.count += 1;
+}
+
+void EnvelopeAccumulator::Merge(const EnvelopeAccumulator& other) {
+  for (const auto& o : other.sums_) {
+    auto& s = sums_[o.first];
+    s.sum += o.second.sum;
+    s.count += o.second.count;
+  }
+}
+
+std::vector<EnvelopeRow> EnvelopeAccumulator::GetRows() const {
+  std::vector<uint64_t> keys;
+  keys.reserve(sums_.size());
+  for (const auto& s : sums_) {
+    keys.push_back(s.first);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<EnvelopeRow> rows;
+  rows.reserve(keys.size());
+  for (const auto key : keys) {
+    const auto& s = sums_.find(key)->second;
+    EnvelopeRow row;
+    row.month = static_cast<int>(key >> (2 * KEY_BITS));
+    row.category = static_cast<int>((key >> KEY_BITS) & KEY_MASK) - 1;
+    row.currency = static_cast<int>(key & KEY_MASK);
+    row.sum = s.sum;
+    row.count = s.count;
+    rows.push_back(row);
+  }
+  return rows;
+}
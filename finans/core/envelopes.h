@@ -0,0 +1,46 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_ENVELOPES_H_
+#define CORE_ENVELOPES_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// spending per category (envelope), month and currency
+struct EnvelopeRow {
+  int month;  // index into EnvelopeReport::months
+  int category;  // -1 for uncategorized
+  int currency;
+  int64_t sum;
+  int count;
+};
+
+struct EnvelopeReport {
+  // the start of each month, ascending
+  std::vector<int64_t> months;
+  // sorted by month, category and currency
+  std::vector<EnvelopeRow> rows;
+};
+
+// the index of the month the time is in, months are the starts of each month.
+// times before the first month are put in the first month
+int FindMonth(const std::vector<int64_t>& months, int64_t when);
+
+// sums up a part of the exchanges, one per thread that are merged when done
+class EnvelopeAccumulator {
+public:
+  void Add(int month, int category, int currency, int64_t value);
+  void Merge(const EnvelopeAccumulator& other);
+  std::vector<EnvelopeRow> GetRows() const;
+
+private:
+  struct Sum {
+    Sum();
+    int64_t sum;
+    int count;
+  };
+  std::unordered_map<uint64_t, Sum> sums_;
+};
+
+#endif  // CORE_ENVELOPES_H_
@@ -0,0 +1,62 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/exchangecolumns.h"
+
+void ExchangeColumns::Clear() {
+  whens_.clear();
+  values_.clear();
+  accounts_.clear();
+  currencies_.clear();
+  companies_.clear();
+  categories_.clear();
+}
+
+void ExchangeColumns::Reserve(std::size_t size) {
+  whens_.reserve(size);
+  values_.reserve(size);
+  accounts_.reserve(size);
+  currencies_.reserve(size);
+  companies_.reserve(size);
+  categories_.reserve(size);
+}
+
+void ExchangeColumns::Add(int account, int currency, int company, int category, int value, int64_t when) {
+  whens_.push_back(when);
+  values_.push_back(value);
+  accounts_.push_back(account);
+  currencies_.push_back(currency);
+  companies_.push_back(company);
+  categories_.push_back(category);
+}
+
+std::size_t ExchangeColumns::size() const {
+  return whens_.size();
+}
+
+bool ExchangeColumns::empty() const {
+  return whens_.empty();
+}
+
+const std::vector<int64_t>& ExchangeColumns::whens() const {
+  return whens_;
+}
+
+const std::vector<int>& ExchangeColumns::values() const {
+  return values_;
+}
+
+const std::vector<int>& ExchangeColumns::accounts() const {
+  return accounts_;
+}
+
+const std::vector<int>& ExchangeColumns::currencies() const {
+  return currencies_;
+}
+
+const std::vector<int>& ExchangeColumns::companies() const {
+  return companies_;
+}
+
+const std::vector<int>& ExchangeColumns::categories() const {
+  return categories_;
+}
@@ -0,0 +1,40 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_EXCHANGECOLUMNS_H_
+#define CORE_EXCHANGECOLUMNS_H_
+
+#include <cstdint>
+#include <vector>
+
+// the external exchanges stored as one array per field. the proto messages
+// are separate heap objects, this lets a aggregation walk only the fields it
+// needs in contiguous memory
+class ExchangeColumns {
+public:
+  void Clear();
+  void Reserve(std::size_t size);
+
+  // currency is the currency of the account, stored so aggregations don't
+  // need to look up the account for every exchange
+  void Add(int account, int currency, int company, int category, int value, int64_t when);
+
+  std::size_t size() const;
+  bool empty() const;
+
+  const std::vector<int64_t>& whens() const;
+  const std::vector<int>& values() const;
+  const std::vector<int>& accounts() const;
+  const std::vector<int>& currencies() const;
+  const std::vector<int>& companies() const;
+  const std::vector<int>& categories() const;
+
+private:
+  std::vector<int64_t> whens_;
+  std::vector<int> values_;
+  std::vector<int> accounts_;
+  std::vector<int> currencies_;
+  std::vector<int> companies_;
+  std::vector<int> categories_;
+};
+
+#endif  // CORE_EXCHANGECOLUMNS_H_
@@ -2,9 +2,134 @@
 
 #include "finans/core/file.h"
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef FINANS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
 #include <fstream>
+#include <vector>
 
 bool FileExist(const std::string& file) {
   std::ifstream ff(file.c_str());
   return ff.is_open();
 }
+
+bool GetFileInfo(const std::string& file, int64_t* size, int64_t* modified) {
+  struct stat info;
+  if (stat(file.c_str(), &info) != 0) return false;
+  *size = static_cast<int64_t>(info.st_size);
+  *modified = static_cast<int64_t>(info.st_mtime);
+  return true;
+}
+
+bool HashFile(const std::string& file, uint64_t* hash) {
+  std::ifstream f(file.c_str(), std::ios::in | std::ios::binary);
+  if (!f) return false;
+
+  // fnv-1a
+  uint64_t h = 14695981039346656037ull;
+  std::vector<char> buffer(64 * 1024);
+  while (f) {
+    f.read(&buffer[0], buffer.size());
+    const auto read = f.gcount();
+    for (std::streamsize i = 0; i < read; ++i) {
+      h ^= static_cast<unsigned char>(buffer[i]);
+      h *= 1099511628211ull;
+    }
+  }
+  if (f.bad()) return false;
+
+  *hash = h;
+  return true;
+}
+
+std::string ReplaceFile(const std::string& file, const std::string& content) {
+  const auto temp = file + ".tmp";
+  {
+    std::ofstream f(temp.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!f) return "Unable to write " + temp;
+    f.write(content.data(), content.size());
+    f.flush();
+    f.close();
+    if (!f) {
+      std::remove(temp.c_str());
+      return "Unable to write " + temp;
+    }
+  }
+#ifndef FINANS_UNIX
+  // rename doesn't replace a existing file here
+  std::remove(file.c_str());
+#endif
+  if (std::rename(temp.c_str(), file.c_str()) != 0) {
+    std::remove(temp.c_str());
+    return "Unable to replace " + file;
+  }
+  return "";
+}
+
+MappedFile::MappedFile() : map_(nullptr), size_(0) {
+}
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+std::string MappedFile::Open(const std::string& file) {
+  Close();
+#ifdef FINANS_UNIX
+  const int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) return "Unable to open " + file;
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return "Unable to read " + file;
+  }
+  size_ = static_cast<std::size_t>(info.st_size);
+  // mapping a empty file fails, but a empty file is just empty
+  if (size_ > 0) {
+    void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      close(fd);
+      size_ = 0;
+      return "Unable to map " + file;
+    }
+    // the file is read from start to end
+    madvise(map, size_, MADV_SEQUENTIAL);
+    map_ = map;
+  }
+  close(fd);
+  return "";
+#else
+  std::ifstream f(file.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+  if (!f) return "Unable to open " + file;
+  content_.resize(static_cast<std::size_t>(f.tellg()));
+  f.seekg(0, std::ios::beg);
+  if (content_.empty() == false) f.read(&content_[0], content_.size());
+  if (!f) return "Unable to read " + file;
+  size_ = content_.size();
+  return "";
+#endif
+}
+
+void MappedFile::Close() {
+#ifdef FINANS_UNIX
+  if (map_ != nullptr) munmap(map_, size_);
+#endif
+  map_ = nullptr;
+  size_ = 0;
+  content_.clear();
+}
+
+const char* MappedFile::data() const {
+  return map_ != nullptr ? static_cast<const char*>(map_) : content_.data();
+}
+
+std::size_t MappedFile::size() const {
+  return size_;
+}
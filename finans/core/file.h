@@ -4,7 +4,42 @@
 #define CORE_FILE_H_
 
 #include <string>
+#include <cstddef>
+#include <cstdint>
 
 bool FileExist(const std::string& file);
 
+// size in bytes and modification time in seconds
+bool GetFileInfo(const std::string& file, int64_t* size, int64_t* modified);
+
+// fast non cryptographic hash of the file content
+bool HashFile(const std::string& file, uint64_t* hash);
+
+// writes the content to file.tmp and renames it over the file, so a failed
+// write leaves the old file as it was. returns a error or a empty string
+std::string ReplaceFile(const std::string& file, const std::string& content);
+
+// the content of a file, memory mapped where that is supported and read
+// into memory where it isn't
+class MappedFile {
+public:
+  MappedFile();
+  ~MappedFile();
+
+  // returns a error or a empty string
+  std::string Open(const std::string& file);
+  void Close();
+
+  const char* data() const;
+  std::size_t size() const;
+
+private:
+  MappedFile(const MappedFile&);
+  void operator=(const MappedFile&);
+
+  void* map_;
+  std::size_t size_;
+  std::string content_;
+};
+
 #endif  // CORE_FILE_H_
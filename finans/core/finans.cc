@@ -1,23 +1,278 @@
 #include "finans/core/finans.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
 #include "finans/core/finans-proto.h"
 
+#include "finans/core/cache.h"
 #include "finans/core/os.h"
 #include "finans/core/configuration.h"
 #include "finans/core/os.h"
 #include "finans/core/file.h"
+#include "finans/core/journal.h"
+#include "finans/core/kernels.h"
 #include "finans/core/proto.h"
+#include "finans/core/query.h"
 #include "finans/core/stringutils.h"
+#include "finans/core/threadpool.h"
 
 const std::string DEFAULT_NAME = "finans.json";
+const std::string BINARY_NAME = "finans.bin";
+const std::string JOURNAL_NAME = "finans.journal";
+const std::string CACHE_NAME = "finans.cache";
+
+// bump when the content of the summaries change
+const int SUMMARY_VERSION = 2;
+
+namespace {
+SnapshotFormat FormatFromDevice(const finans::DeviceConfigutation& device) {
+  switch (device.format()) {
+  case finans::DeviceConfigutation::BINARY:
+    return SnapshotFormat::BINARY;
+  default:
+    return SnapshotFormat::JSON;
+  }
+}
+
+finans::DeviceConfigutation::Format FormatToDevice(SnapshotFormat format) {
+  switch (format) {
+  case SnapshotFormat::BINARY:
+    return finans::DeviceConfigutation::BINARY;
+  default:
+    return finans::DeviceConfigutation::JSON;
+  }
+}
+
+const std::string& SnapshotName(SnapshotFormat format) {
+  return format == SnapshotFormat::BINARY ? BINARY_NAME : DEFAULT_NAME;
+}
+
+std::string SnapshotPath(const finans::DeviceConfigutation& device, SnapshotFormat format) {
+  return EndWithSlash(device.finans_path()) + SnapshotName(format);
+}
+
+// the journal lives next to the snapshot and is shared between formats
+std::string JournalPath(const std::string& snapshot) {
+  const auto slash = snapshot.find_last_of("/\\");
+  if (slash == std::string::npos) return JOURNAL_NAME;
+  return snapshot.substr(0, slash + 1) + JOURNAL_NAME;
+}
+
+void AddToBalances(const ExchangeColumns& c, std::size_t i, Balances* balances) {
+  balances->Add(c.accounts()[i], c.currencies()[i], c.values()[i]);
+}
+
+// all the exchanges from begin and on
+void AddAllToBalances(const ExchangeColumns& c, std::size_t begin, Balances* balances) {
+  if (begin >= c.size()) return;
+  balances->AddAll(c.accounts().data() + begin, c.currencies().data() + begin, c.values().data() + begin, c.size() - begin);
+}
+
+void AddToBalances(const finans::InternalExchange& e, Balances* balances) {
+  balances->Add(e.from_account(), e.from_currency(), -static_cast<int64_t>(e.from_value()));
+  balances->Add(e.to_account(), e.to_currency(), e.to_value());
+}
+
+void AddToHistory(const ExchangeColumns& c, std::size_t i, BalanceHistory* history) {
+  history->Add(c.accounts()[i], c.currencies()[i], c.whens()[i], c.values()[i]);
+}
+
+void AddToHistory(const finans::InternalExchange& e, BalanceHistory* history) {
+  history->Add(e.from_account(), e.from_currency(), e.when(), -static_cast<int64_t>(e.from_value()));
+  history->Add(e.to_account(), e.to_currency(), e.when(), e.to_value());
+}
+
+// the local start of every month from the month of first to the month of last
+std::vector<int64_t> MonthsBetween(UtcOffsetTable* local_time, int64_t first, int64_t last) {
+  const auto start = local_time->LocalDate(first);
+  auto year = start.year;
+  auto month = start.month;
+  std::vector<int64_t> months;
+  for (;;) {
+    const auto time = local_time->Midnight(DaysFromCivil(year, month, 1));
+    if (months.empty() == false && time > last) break;
+    months.push_back(time);
+    month += 1;
+    if (month > 12) {
+      month = 1;
+      year += 1;
+    }
+  }
+  return months;
+}
+
+void WriteColumns(const ExchangeColumns& c, finans::Finans* f) {
+  f->clear_external_exchanges();
+  f->mutable_external_exchanges()->Reserve(static_cast<int>(c.size()));
+  for (std::size_t i = 0; i < c.size(); ++i) {
+    auto* e = f->add_external_exchanges();
+    e->set_account(c.accounts()[i]);
+    e->set_company(c.companies()[i]);
+    e->set_category(c.categories()[i]);
+    e->set_value(c.values()[i]);
+    e->set_when(c.whens()[i]);
+  }
+}
+
+class FinansQueryNames : public QueryNames {
+public:
+  explicit FinansQueryNames(const Finans& finans) : finans_(finans) { }
+  int GetAccountByName(const std::string& name) const override { return finans_.GetAccountByName(name); }
+  int GetCompanyByName(const std::string& name) const override { return finans_.GetCompanyByName(name); }
+  int GetCurrencyByName(const std::string& name) const override { return finans_.GetCurrencyByName(name); }
+  int GetCategoryByName(const std::string& name) const override { return finans_.GetCategoryByName(name); }
+
+private:
+  const Finans& finans_;
+};
+
+uint64_t Fingerprint(uint64_t hash, int64_t value) {
+  // fnv-1a over the bytes of the value
+  for (int i = 0; i < 8; ++i) {
+    hash ^= static_cast<uint64_t>(value >> (8 * i)) & 0xFF;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+uint64_t FingerprintExchange(uint64_t hash, int account, int company, int category, int value, int64_t when) {
+  hash = Fingerprint(hash, account);
+  hash = Fingerprint(hash, company);
+  hash = Fingerprint(hash, category);
+  hash = Fingerprint(hash, value);
+  return Fingerprint(hash, when);
+}
+
+const uint64_t EMPTY_FINGERPRINT = 14695981039346656037ull;
+
+int64_t NextMonthStart(UtcOffsetTable* local_time, int64_t month) {
+  // 32 days after the first is always in the next month
+  return local_time->MonthStart(month + 32 * 24 * 60 * 60);
+}
+
+// the months are keyed by their local start, so summaries stored in one time
+// zone are wrong in another. months is the stored keys
+uint64_t FingerprintZone(UtcOffsetTable* local_time, const std::vector<int64_t>& months) {
+  auto hash = EMPTY_FINGERPRINT;
+  for (const auto month : months) {
+    const auto start = local_time->MonthStart(month);
+    hash = Fingerprint(hash, start);
+    hash = Fingerprint(hash, NextMonthStart(local_time, start));
+  }
+  return hash;
+}
+
+// a exchange between currencies says what the rate was at the time
+void AddImpliedRate(const finans::InternalExchange& e, RateTable* rates) {
+  if (e.from_currency() == e.to_currency()) return;
+  if (e.from_value() <= 0 || e.to_value() <= 0) return;
+  rates->Add(e.from_currency(), e.to_currency(), e.when(), static_cast<double>(e.to_value()) / e.from_value());
+}
+
+// the indices in a snapshot or journal are used directly, so a file edited
+// by hand or written by something else needs to be checked before use.
+// the checks return a error or a empty string
+std::string CheckIndex(int index, int size, bool allow_none, const char* what, const char* where) {
+  if ((allow_none && index == -1) || (index >= 0 && index < size)) return "";
+  return std::string("Invalid ") + what + " " + std::to_string(index) + " in " + where;
+}
+
+std::string CheckAccount(const finans::Finans& f, const finans::Account& a) {
+  auto error = CheckIndex(a.prefered_currency(), f.currencies_size(), false, "currency", "a account");
+  for (const auto& money : a.money()) {
+    if (error.empty()) error = CheckIndex(money.currency(), f.currencies_size(), false, "currency", "the money of a account");
+  }
+  return error;
+}
+
+std::string CheckExchange(const finans::Finans& f, const finans::ExternalExchange& e) {
+  auto error = CheckIndex(e.account(), f.accounts_size(), false, "account", "a external exchange");
+  if (error.empty()) error = CheckIndex(e.company(), f.companies_size(), false, "company", "a external exchange");
+  if (error.empty()) error = CheckIndex(e.category(), f.categories_size(), true, "category", "a external exchange");
+  return error;
+}
+
+std::string CheckExchange(const finans::Finans& f, const finans::InternalExchange& e) {
+  auto error = CheckIndex(e.from_account(), f.accounts_size(), false, "account", "a internal exchange");
+  if (error.empty()) error = CheckIndex(e.to_account(), f.accounts_size(), false, "account", "a internal exchange");
+  if (error.empty()) error = CheckIndex(e.from_currency(), f.currencies_size(), false, "currency", "a internal exchange");
+  if (error.empty()) error = CheckIndex(e.to_currency(), f.currencies_size(), false, "currency", "a internal exchange");
+  return error;
+}
+
+std::string CheckRate(const finans::Finans& f, const finans::Rate& r) {
+  auto error = CheckIndex(r.from_currency(), f.currencies_size(), false, "currency", "a rate");
+  if (error.empty()) error = CheckIndex(r.to_currency(), f.currencies_size(), false, "currency", "a rate");
+  if (error.empty() && !(r.rate() > 0)) error = "Invalid rate " + std::to_string(r.rate());
+  return error;
+}
+
+std::string CheckSnapshot(const finans::Finans& f) {
+  for (const auto& a : f.accounts()) {
+    const auto error = CheckAccount(f, a);
+    if (error.empty() == false) return error;
+  }
+  for (const auto& e : f.external_exchanges()) {
+    const auto error = CheckExchange(f, e);
+    if (error.empty() == false) return error;
+  }
+  for (const auto& e : f.internal_exchanges()) {
+    const auto error = CheckExchange(f, e);
+    if (error.empty() == false) return error;
+  }
+  for (const auto& r : f.rates()) {
+    const auto error = CheckRate(f, r);
+    if (error.empty() == false) return error;
+  }
+  return "";
+}
+
+// checked against what was there before the mutation
+std::string CheckMutation(const finans::Finans& f, const finans::Mutation& m) {
+  std::string error;
+  if (m.has_account()) error = CheckAccount(f, m.account());
+  if (error.empty() && m.has_external_exchange()) error = CheckExchange(f, m.external_exchange());
+  if (error.empty() && m.has_internal_exchange()) error = CheckExchange(f, m.internal_exchange());
+  if (error.empty() && m.has_rate()) error = CheckRate(f, m.rate());
+  return error;
+}
+
+bool IsOnlyExternalExchange(const finans::Mutation& m) {
+  return m.has_external_exchange() && m.has_account() == false && m.has_company() == false &&
+    m.has_currency() == false && m.has_category() == false && m.has_internal_exchange() == false && m.has_rate() == false;
+}
+
+MoneyFormat CompileMoneyFormat(const finans::Currency& c) {
+  if (c.value_before().empty() && c.value_after().empty()) return MoneyFormat::Plain(c.short_name());
+  return MoneyFormat(c.value_before(), c.value_after());
+}
+
+typedef std::chrono::steady_clock Clock;
+
+double MillisecondsSince(const Clock::time_point& start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+}  // namespace
 
 std::shared_ptr<Finans> Finans::CreateNew() {
   finans::DeviceConfigutation device;
   if( false == LoadConfiguration(&device) ) throw "Unable to load configuration, install required";
 
-  const auto target = EndWithSlash(device.finans_path()) + DEFAULT_NAME;
-  if (FileExist(target) == false) throw "Missing " + DEFAULT_NAME + ", create required";
-  std::shared_ptr<Finans> f(new Finans(target));
+  const auto format = FormatFromDevice(device);
+  const auto target = SnapshotPath(device, format);
+  if (FileExist(target) == false) throw "Missing " + SnapshotName(format) + ", create required";
+  const auto user = FindUserPath();
+  return Open(target, format, user.empty() ? "" : user + CACHE_NAME, static_cast<uint64_t>(device.journal_compact_size()));
+}
+
+std::shared_ptr<Finans> Finans::Open(const std::string& path, SnapshotFormat format, const std::string& cache_path, uint64_t journal_compact_size) {
+  std::shared_ptr<Finans> f(new Finans(path, format));
+  f->journal_limit_ = journal_compact_size;
+  f->cache_path_ = cache_path;
   f->Load();
   return f;
 }
@@ -25,7 +280,7 @@ std::shared_ptr<Finans> Finans::CreateNew() {
 void Finans::CreateDefault(const std::string& src) {
   const auto target = EndWithSlash(src) + DEFAULT_NAME;
   if (FileExist(target)) return;
-  Finans f(target);
+  Finans f(target, SnapshotFormat::JSON);
   f.Save();
 }
 
@@ -33,20 +288,641 @@ void Finans::Install(const std::string& path, bool create_if_missing) {
   InstallConfiguration(path, create_if_missing);
 }
 
-Finans::Finans(const std::string& path) : path_(path), finans_(new finans::Finans()) {
+void Finans::Convert(SnapshotFormat format) {
+  finans::DeviceConfigutation device;
+  if (false == LoadConfiguration(&device)) throw "Unable to load configuration, install required";
+
+  const auto source = SnapshotPath(device, FormatFromDevice(device));
+  if (FileExist(source) == false) throw "Missing " + source + ", create required";
+
+  // load detects the format by itself, so only the save needs to know
+  Finans f(source, format);
+  f.Load();
+  f.path_ = SnapshotPath(device, format);
+  f.Compact();
+
+  device.set_format(FormatToDevice(format));
+  SaveConfiguration(device);
+
+  // everything in the old snapshot is in the new one, left behind it only
+  // takes space and looks like the ledger to anyone browsing the folder
+  if (f.path_ != source) std::remove(source.c_str());
+}
+
+Finans::Finans(const std::string& path, SnapshotFormat format)
+  : path_(path)
+  , journal_path_(JournalPath(path))
+  , format_(format)
+  , finans_(new finans::Finans())
+  , external_fingerprint_(EMPTY_FINGERPRINT)
+  , journal_size_(0)
+  , journal_limit_(finans::DeviceConfigutation::default_instance().journal_compact_size())
+  , needs_compaction_(true)
+  , journal_damaged_(false)
+  , disk_state_({ -1, -1, -1, -1 }) {
 }
 
 Finans::~Finans() {
 }
 
+LoadTiming::LoadTiming()
+  : cache_enabled(false)
+  , cache_hit(false)
+  , snapshot(0)
+  , journal(0)
+  , journal_records(0)
+  , total(0) {
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 void Finans::Load() {
-  LoadProtoJson(finans_.get(), path_);
+  const auto start = Clock::now();
+  load_timing_ = LoadTiming();
+  journal_damaged_ = false;
+  finans_->Clear();
+  pending_.clear();
+
+  // binary snapshots are already as fast to load as the cache
+  const bool binary = IsProtoBinary(path_);
+  load_timing_.cache_enabled = binary == false && cache_path_.empty() == false;
+  if (load_timing_.cache_enabled) {
+    load_timing_.cache_hit = LoadLedgerCache(cache_path_, path_, finans_.get());
+  }
+
+  if (load_timing_.cache_hit == false) {
+    finans_->Clear();
+    const auto error = binary
+      ? LoadProtoBinary(finans_.get(), path_)
+      : LoadProtoJson(finans_.get(), path_);
+    if (error.empty() == false) throw "Unable to load " + path_ + ": " + error;
+
+    // the cache is only a speedup, failing to write it isn't a error
+    if (load_timing_.cache_enabled) SaveLedgerCache(cache_path_, path_, *finans_);
+  }
+  const auto snapshot_error = CheckSnapshot(*finans_);
+  if (snapshot_error.empty() == false) throw "Unable to load " + path_ + ": " + snapshot_error;
+  TakeExternalExchanges();
+  RebuildIndexes();
+  LoadBalances();
+  LoadSummaries();
+  load_timing_.snapshot = MillisecondsSince(start);
+
+  const auto journal_start = Clock::now();
+  JournalContent journal;
+  const auto journal_error = ReadJournal(journal_path_, &journal);
+  if (journal_error.empty() == false) {
+    journal_damaged_ = true;
+    throw "Unable to load " + journal_path_ + ": " + journal_error;
+  }
+
+  journal_size_ = journal.file_size;
+  if (journal.exists == false || journal.generation != finans_->journal_generation()) {
+    // either there is no journal or the snapshot was written after it,
+    // in both cases we need a new one before we can append anything
+    needs_compaction_ = true;
+  }
+  else {
+    std::vector<finans::Mutation> mutations(journal.records.size());
+    for (std::size_t i = 0; i < journal.records.size(); ++i) {
+      if (false == mutations[i].ParseFromString(journal.records[i])) {
+        journal_damaged_ = true;
+        throw "Corrupt journal " + journal_path_;
+      }
+    }
+    try {
+      ApplyAll(mutations);
+    }
+    catch (const std::string& error) {
+      journal_damaged_ = true;
+      throw "Unable to load " + journal_path_ + ": " + error;
+    }
+    load_timing_.journal_records = static_cast<int>(journal.records.size());
+
+    // a torn record at the end can't be appended after
+    needs_compaction_ = journal.valid_size != journal.file_size;
+  }
+  load_timing_.journal = MillisecondsSince(journal_start);
+  load_timing_.total = MillisecondsSince(start);
+  disk_state_ = ReadDiskState();
 }
 
 void Finans::Save() {
-  SaveProtoJson(*finans_.get(), path_);
+  if (journal_damaged_) throw "Refusing to save, " + journal_path_ + " is damaged";
+  // compact rather than let the journal grow to the limit
+  if (needs_compaction_ || journal_size_ + JournalRecordsSize(pending_) >= journal_limit_) {
+    Compact();
+    return;
+  }
+
+  if (pending_.empty()) return;
+
+  uint64_t written = 0;
+  const auto error = AppendJournal(journal_path_, pending_, &written);
+  if (error.empty() == false) throw "Unable to save " + journal_path_ + ": " + error;
+  journal_size_ += written;
+  pending_.clear();
+  disk_state_ = ReadDiskState();
+}
+
+void Finans::Compact() {
+  if (journal_damaged_) throw "Refusing to compact, " + journal_path_ + " is damaged";
+  // bump the generation first, if we crash after the snapshot is written
+  // but before the journal is reset the old journal is ignored on load
+  const auto generation = finans_->journal_generation() + 1;
+  finans_->set_journal_generation(generation);
+  StoreBalances();
+  StoreSummaries();
+
+  // the columns are written to the proto only while it is saved
+  WriteColumns(external_, finans_.get());
+  const auto error = format_ == SnapshotFormat::BINARY
+    ? SaveProtoBinary(*finans_.get(), path_)
+    : SaveProtoJson(*finans_.get(), path_);
+  if (error.empty() == false) {
+    // the old snapshot and journal are still on disk and still belong together
+    finans_->set_journal_generation(generation - 1);
+    finans_->clear_external_exchanges();
+    finans_->clear_summaries();
+    throw "Unable to save " + path_ + ": " + error;
+  }
+
+  // the journal is only reset once the new snapshot is in place
+  const auto journal_error = ResetJournal(journal_path_, generation);
+  if (journal_error.empty() == false) throw "Unable to save " + journal_path_ + ": " + journal_error;
+
+  // we have the parsed snapshot in memory, so the next load doesn't need to parse it
+  if (format_ == SnapshotFormat::JSON && cache_path_.empty() == false) {
+    SaveLedgerCache(cache_path_, path_, *finans_);
+  }
+  finans_->clear_external_exchanges();
+  finans_->clear_summaries();
+
+  pending_.clear();
+  journal_size_ = EmptyJournalSize();
+  needs_compaction_ = false;
+  disk_state_ = ReadDiskState();
+}
+
+const LoadTiming& Finans::load_timing() const {
+  return load_timing_;
+}
+
+bool Finans::IsChangedOnDisk() const {
+  const auto now = ReadDiskState();
+  return now.snapshot_size != disk_state_.snapshot_size || now.snapshot_modified != disk_state_.snapshot_modified ||
+    now.journal_size != disk_state_.journal_size || now.journal_modified != disk_state_.journal_modified;
+}
+
+Finans::DiskState Finans::ReadDiskState() const {
+  DiskState state = { -1, -1, -1, -1 };
+  if (false == GetFileInfo(path_, &state.snapshot_size, &state.snapshot_modified)) {
+    state.snapshot_size = state.snapshot_modified = -1;
+  }
+  if (false == GetFileInfo(journal_path_, &state.journal_size, &state.journal_modified)) {
+    state.journal_size = state.journal_modified = -1;
+  }
+  return state;
+}
+
+void Finans::ImportJson(const std::string& path) {
+  finans::Finans imported;
+  const auto error = LoadProtoJson(&imported, path);
+  if (error.empty() == false) throw "Unable to import " + path + ": " + error;
+  const auto check = CheckSnapshot(imported);
+  if (check.empty() == false) throw "Unable to import " + path + ": " + check;
+
+  // keep our generation so the current journal can't be replayed on the import
+  imported.set_journal_generation(finans_->journal_generation());
+  finans_->Swap(&imported);
+  TakeExternalExchanges();
+  RebuildIndexes();
+  LoadBalances();
+  LoadSummaries();
+  pending_.clear();
+  needs_compaction_ = true;
+}
+
+void Finans::ExportJson(const std::string& path) const {
+  finans::Finans exported(*finans_);
+  WriteColumns(external_, &exported);
+  const auto error = SaveProtoJson(exported, path);
+  if (error.empty() == false) throw "Unable to export " + path + ": " + error;
+}
+
+int Finans::ImportCsv(const std::string& path, int account, const CsvFormat& format, int threads, Rules* rules, ReconcileReport* reconcile) {
+  if (account < 0 || account >= NumberOfAccounts()) throw "Invalid account";
+
+  MappedFile file;
+  auto error = file.Open(path);
+  if (error.empty() == false) throw "Unable to import " + path + ": " + error;
+  CsvImport imported;
+  error = ParseCsv(file.data(), file.size(), format, companies_, threads, &imported);
+  if (error.empty() == false) throw "Unable to import " + path + ", " + error;
+  file.Close();
+
+  std::vector<int> rule_categories;
+  if (rules) {
+    for (const auto& rule : rules->rules()) {
+      const auto category = rule.category.empty() ? -1 : GetCategoryByName(rule.category);
+      if (category == -1 && rule.category.empty() == false) throw "Unknown category " + rule.category + " in rule " + rule.pattern;
+      rule_categories.push_back(category);
+    }
+  }
+
+  // companies that don't exist yet get a negative placeholder until they
+  // are added, so they can't match anything in the ledger
+  std::vector<std::string> new_companies;
+  NameIndex new_company_index;
+  auto resolve = [&](const std::string& name) -> int {
+    const auto company = companies_.Find(name);
+    if (company != -1) return company;
+    auto index = new_company_index.Find(name);
+    if (index == -1) {
+      index = static_cast<int>(new_companies.size());
+      new_company_index.Add(name, index);
+      new_companies.push_back(name);
+    }
+    return -1 - index;
+  };
+
+  // the rules are run once per payee, not once per row
+  struct Payee {
+    bool resolved;
+    int rule;
+    int company;
+    int category;
+  };
+  std::vector<Payee> payees(NumberOfCompanies() + imported.new_payees.size(), Payee{ false, -1, -1, -1 });
+  std::vector<int> categories(imported.rows.size(), -1);
+
+  ReconcileReport all;
+  ReconcileReport* report = reconcile ? reconcile : &all;
+  report->rows.resize(imported.rows.size());
+  for (std::size_t i = 0; i < imported.rows.size(); ++i) {
+    const auto& row = imported.rows[i];
+    auto& payee = payees[row.company != -1 ? row.company : NumberOfCompanies() + row.payee];
+    if (payee.resolved == false) {
+      const auto& name = row.company != -1 ? GetCompanyName(row.company) : imported.new_payees[row.payee];
+      payee.resolved = true;
+      payee.rule = rules ? rules->Find(name) : -1;
+      const auto* rule = payee.rule != -1 ? &rules->rules()[payee.rule] : nullptr;
+      payee.company = rule && rule->company.empty() == false ? resolve(rule->company)
+        : row.company != -1 ? row.company : resolve(name);
+      payee.category = rule ? rule_categories[payee.rule] : -1;
+    }
+    if (payee.rule != -1) rules->AddHit(payee.rule);
+    categories[i] = payee.category;
+
+    auto& r = report->rows[i];
+    r.account = account;
+    r.company = payee.company;
+    r.value = row.value;
+    r.when = row.when;
+    r.status = ReconcileStatus::NEW;
+    r.matches.clear();
+  }
+  if (reconcile) {
+    ReconcileAgainstLedger(reconcile);
+  }
+
+  const auto first_new_company = NumberOfCompanies();
+  for (const auto& name : new_companies) {
+    AddCompany(name, GetAccountCurrency(account));
+  }
+  std::vector<finans::Mutation> mutations;
+  for (std::size_t i = 0; i < report->rows.size(); ++i) {
+    auto& row = report->rows[i];
+    if (row.company < 0) row.company = first_new_company - 1 - row.company;
+    if (row.status != ReconcileStatus::NEW) continue;
+    finans::Mutation m;
+    auto* e = m.mutable_external_exchange();
+    e->set_account(account);
+    e->set_company(row.company);
+    e->set_category(categories[i]);
+    e->set_value(row.value);
+    e->set_when(row.when);
+    mutations.push_back(m);
+  }
+  // statements are often newest first, so they are added as one batch
+  RecordAll(mutations);
+  return static_cast<int>(mutations.size());
+}
+
+void Finans::ReconcileAgainstLedger(ReconcileReport* report) const {
+  if (report->rows.empty()) {
+    Reconcile(external_, std::vector<int>(), report);
+    return;
+  }
+
+  // only the part of the ledger the rows cover needs to be looked at, with
+  // a margin for the local day
+  const int64_t margin = 2 * 24 * 60 * 60;
+  int64_t from = report->rows[0].when;
+  int64_t to = report->rows[0].when;
+  for (const auto& row : report->rows) {
+    from = std::min(from, row.when);
+    to = std::max(to, row.when);
+  }
+  std::vector<int> existing;
+  for (const auto index : external_times_.Range(from - margin, to + margin)) {
+    existing.push_back(index);
+  }
+  Reconcile(external_, existing, report);
+}
+
+void Finans::Apply(const finans::Mutation& mutation) {
+  const auto error = CheckMutation(*finans_, mutation);
+  if (error.empty() == false) throw error;
+  if (mutation.has_account()) {
+    accounts_.Add(mutation.account().short_name(), finans_->accounts_size());
+    finans_->add_accounts()->CopyFrom(mutation.account());
+  }
+  if (mutation.has_company()) {
+    companies_.Add(mutation.company().name(), finans_->companies_size());
+    finans_->add_companies()->CopyFrom(mutation.company());
+  }
+  if (mutation.has_currency()) {
+    currencies_.Add(mutation.currency().short_name(), finans_->currencies_size());
+    money_formats_.push_back(CompileMoneyFormat(mutation.currency()));
+    finans_->add_currencies()->CopyFrom(mutation.currency());
+  }
+  if (mutation.has_category()) {
+    categories_.Add(mutation.category().name(), finans_->categories_size());
+    finans_->add_categories()->CopyFrom(mutation.category());
+  }
+  if (mutation.has_external_exchange()) {
+    const auto& e = mutation.external_exchange();
+    const auto index = external_.size();
+    external_fingerprint_ = FingerprintExchange(external_fingerprint_, e.account(), e.company(), e.category(), e.value(), e.when());
+    summaries_.Invalidate(local_time_.MonthStart(e.when()));
+    external_.Add(e.account(), finans_->accounts(e.account()).prefered_currency(), e.company(), e.category(), e.value(), e.when());
+    AddToBalances(external_, index, &balances_);
+    AddToHistory(external_, index, &history_);
+    external_times_.Add(e.when(), static_cast<int>(index));
+  }
+  if (mutation.has_internal_exchange()) {
+    AddToBalances(mutation.internal_exchange(), &balances_);
+    AddToHistory(mutation.internal_exchange(), &history_);
+    AddImpliedRate(mutation.internal_exchange(), &rates_);
+    internal_times_.Add(mutation.internal_exchange().when(), finans_->internal_exchanges_size());
+    finans_->add_internal_exchanges()->CopyFrom(mutation.internal_exchange());
+  }
+  if (mutation.has_rate()) {
+    const auto& r = mutation.rate();
+    rates_.Add(r.from_currency(), r.to_currency(), r.when(), r.rate());
+    finans_->add_rates()->CopyFrom(r);
+  }
+}
+
+void Finans::ApplyAll(const std::vector<finans::Mutation>& mutations) {
+  if (mutations.empty()) return;
+  const auto* begin = mutations.data();
+  const auto* end = begin + mutations.size();
+  const auto* run = begin;
+  for (const auto* m = begin; m != end; ++m) {
+    if (IsOnlyExternalExchange(*m)) continue;
+    ApplyExternalExchanges(run, m);
+    Apply(*m);
+    run = m + 1;
+  }
+  ApplyExternalExchanges(run, end);
+}
+
+void Finans::ApplyExternalExchanges(const finans::Mutation* begin, const finans::Mutation* end) {
+  if (begin == end) return;
+  for (const auto* m = begin; m != end; ++m) {
+    const auto error = CheckExchange(*finans_, m->external_exchange());
+    if (error.empty() == false) throw error;
+  }
+  const auto first = external_.size();
+  for (const auto* m = begin; m != end; ++m) {
+    const auto& e = m->external_exchange();
+    external_fingerprint_ = FingerprintExchange(external_fingerprint_, e.account(), e.company(), e.category(), e.value(), e.when());
+    summaries_.Invalidate(local_time_.MonthStart(e.when()));
+    external_.Add(e.account(), finans_->accounts(e.account()).prefered_currency(), e.company(), e.category(), e.value(), e.when());
+  }
+  AddAllToBalances(external_, first, &balances_);
+  const auto count = external_.size() - first;
+  history_.AddAll(external_.accounts().data() + first, external_.currencies().data() + first,
+    external_.whens().data() + first, external_.values().data() + first, count);
+  external_times_.AddAll(external_.whens(), first);
+}
+
+void Finans::RebuildIndexes() {
+  accounts_.Clear();
+  for (int i = 0; i < finans_->accounts_size(); ++i) {
+    accounts_.Add(finans_->accounts(i).short_name(), i);
+  }
+  companies_.Clear();
+  for (int i = 0; i < finans_->companies_size(); ++i) {
+    companies_.Add(finans_->companies(i).name(), i);
+  }
+  currencies_.Clear();
+  for (int i = 0; i < finans_->currencies_size(); ++i) {
+    currencies_.Add(finans_->currencies(i).short_name(), i);
+  }
+  money_formats_.clear();
+  for (const auto& currency : finans_->currencies()) {
+    money_formats_.push_back(CompileMoneyFormat(currency));
+  }
+  categories_.Clear();
+  for (int i = 0; i < finans_->categories_size(); ++i) {
+    categories_.Add(finans_->categories(i).name(), i);
+  }
+
+  external_times_.Build(external_.whens());
+
+  std::vector<int64_t> whens(finans_->internal_exchanges_size());
+  for (int i = 0; i < finans_->internal_exchanges_size(); ++i) {
+    whens[i] = finans_->internal_exchanges(i).when();
+  }
+  internal_times_.Build(whens);
+  RebuildHistory();
+  RebuildRates();
+}
+
+void Finans::RebuildRates() {
+  rates_.Clear();
+  for (const auto& r : finans_->rates()) {
+    rates_.Add(r.from_currency(), r.to_currency(), r.when(), r.rate());
+  }
+  for (const auto& e : finans_->internal_exchanges()) {
+    AddImpliedRate(e, &rates_);
+  }
+}
+
+void Finans::RebuildHistory() {
+  // merge the time indexes so every series is built in order
+  history_.Clear();
+  const auto external = external_times_.All();
+  const auto internal = internal_times_.All();
+  auto e = external.begin();
+  auto i = internal.begin();
+  while (e != external.end() || i != internal.end()) {
+    const bool take_external = i == internal.end() ||
+      (e != external.end() && external_.whens()[*e] <= finans_->internal_exchanges(*i).when());
+    if (take_external) {
+      AddToHistory(external_, *e, &history_);
+      ++e;
+    }
+    else {
+      AddToHistory(finans_->internal_exchanges(*i), &history_);
+      ++i;
+    }
+  }
+}
+
+void Finans::LoadBalances() {
+  balances_.Clear();
+  auto external = finans_->balanced_external_exchanges();
+  auto internal = finans_->balanced_internal_exchanges();
+  // files written before the balances were stored have no counts, their
+  // money may already include the exchanges so it isn't a opening balance
+  const bool stored = finans_->has_balanced_external_exchanges() && finans_->has_balanced_internal_exchanges();
+  if (stored == false || external < 0 || static_cast<std::size_t>(external) > external_.size() ||
+      internal < 0 || internal > finans_->internal_exchanges_size()) {
+    // the money can't be trusted, so start over from the exchanges
+    external = 0;
+    internal = 0;
+  }
+  else {
+    for (int account = 0; account < finans_->accounts_size(); ++account) {
+      for (const auto& money : finans_->accounts(account).money()) {
+        balances_.Add(account, money.currency(), money.value());
+      }
+    }
+  }
+
+  // normally nothing, but older files or files edited by hand needs to catch up
+  AddAllToBalances(external_, static_cast<std::size_t>(external), &balances_);
+  for (int i = internal; i < finans_->internal_exchanges_size(); ++i) {
+    AddToBalances(finans_->internal_exchanges(i), &balances_);
+  }
+}
+
+void Finans::StoreBalances() {
+  for (int account = 0; account < finans_->accounts_size(); ++account) {
+    auto* a = finans_->mutable_accounts(account);
+    a->clear_money();
+    for (const auto currency : balances_.GetCurrencies(account)) {
+      auto* money = a->add_money();
+      money->set_currency(currency);
+      money->set_value(balances_.Get(account, currency));
+    }
+  }
+  finans_->set_balanced_external_exchanges(static_cast<int>(external_.size()));
+  finans_->set_balanced_internal_exchanges(finans_->internal_exchanges_size());
+}
+
+void Finans::TakeExternalExchanges() {
+  external_.Clear();
+  external_.Reserve(finans_->external_exchanges_size());
+  external_fingerprint_ = EMPTY_FINGERPRINT;
+  for (const auto& e : finans_->external_exchanges()) {
+    external_fingerprint_ = FingerprintExchange(external_fingerprint_, e.account(), e.company(), e.category(), e.value(), e.when());
+    external_.Add(e.account(), finans_->accounts(e.account()).prefered_currency(), e.company(), e.category(), e.value(), e.when());
+  }
+  finans_->clear_external_exchanges();
+}
+
+void Finans::LoadSummaries() {
+  const auto& stored = finans_->summaries();
+  std::vector<int64_t> months;
+  for (const auto& month : stored.months()) {
+    months.push_back(month.month());
+  }
+  const bool valid = stored.version() == SUMMARY_VERSION &&
+    static_cast<std::size_t>(stored.external_exchanges()) == external_.size() &&
+    stored.fingerprint() == external_fingerprint_ &&
+    stored.zone() == FingerprintZone(&local_time_, months);
+  if (valid) {
+    summaries_.Clear();
+    for (const auto& month : stored.months()) {
+      std::vector<SummaryRow> rows;
+      rows.reserve(month.rows_size());
+      for (const auto& r : month.rows()) {
+        SummaryRow row;
+        row.account = r.account();
+        row.category = r.category();
+        row.currency = r.currency();
+        row.sum = r.sum();
+        row.count = r.count();
+        rows.push_back(row);
+      }
+      summaries_.SetMonth(month.month(), rows);
+    }
+  }
+  else {
+    RebuildSummaries();
+  }
+  // like the exchanges they are only in the proto while saving
+  finans_->clear_summaries();
+}
+
+void Finans::RebuildSummaries() {
+  summaries_.Clear();
+  int64_t month = 0;
+  int64_t next_month = 0;
+  SummaryBuilder builder;
+  bool first = true;
+  for (const auto index : external_times_.All()) {
+    const auto when = external_.whens()[index];
+    if (first || when >= next_month) {
+      if (first == false) summaries_.SetMonth(month, builder.GetRows());
+      first = false;
+      builder = SummaryBuilder();
+      month = local_time_.MonthStart(when);
+      next_month = NextMonthStart(&local_time_, month);
+    }
+    builder.Add(external_.accounts()[index], external_.categories()[index], external_.currencies()[index], external_.values()[index]);
+  }
+  if (first == false) summaries_.SetMonth(month, builder.GetRows());
+}
+
+void Finans::RefreshSummaries() {
+  for (const auto month : summaries_.GetInvalidMonths()) {
+    SummaryBuilder builder;
+    for (const auto index : external_times_.Range(month, NextMonthStart(&local_time_, month))) {
+      builder.Add(external_.accounts()[index], external_.categories()[index], external_.currencies()[index], external_.values()[index]);
+    }
+    summaries_.SetMonth(month, builder.GetRows());
+  }
+}
+
+void Finans::StoreSummaries() {
+  RefreshSummaries();
+  auto* stored = finans_->mutable_summaries();
+  stored->Clear();
+  stored->set_version(SUMMARY_VERSION);
+  stored->set_external_exchanges(static_cast<int>(external_.size()));
+  stored->set_fingerprint(external_fingerprint_);
+  const auto months = summaries_.GetMonths(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+  stored->set_zone(FingerprintZone(&local_time_, months));
+  for (const auto month : months) {
+    auto* m = stored->add_months();
+    m->set_month(month);
+    for (const auto& row : summaries_.GetRows(month)) {
+      auto* r = m->add_rows();
+      r->set_account(row.account);
+      r->set_category(row.category);
+      r->set_currency(row.currency);
+      r->set_sum(row.sum);
+      r->set_count(row.count);
+    }
+  }
+}
+
+void Finans::Record(const finans::Mutation& mutation) {
+  Apply(mutation);
+  pending_.push_back(mutation.SerializeAsString());
+}
+
+void Finans::RecordAll(const std::vector<finans::Mutation>& mutations) {
+  ApplyAll(mutations);
+  for (const auto& mutation : mutations) {
+    pending_.push_back(mutation.SerializeAsString());
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -56,12 +932,15 @@ int Finans::NumberOfAccounts() const {
 }
 
 int Finans::GetAccountByName(const std::string& short_name) const {
-  const auto name = ToLower(short_name);
-  for (int i = 0; i < finans_->accounts_size(); ++i) {
-    if (ToLower(finans_->accounts(i).short_name()) == name) return i;
-  }
+  return accounts_.Find(short_name);
+}
 
-  return -1;
+const std::string& Finans::GetAccountName(int account) const {
+  return finans_->accounts(account).short_name();
+}
+
+int Finans::GetAccountCurrency(int account) const {
+  return finans_->accounts(account).prefered_currency();
 }
 
 void Finans::AddAccount(const std::string& long_name, const std::string& short_name, int currency) {
@@ -69,11 +948,13 @@ void Finans::AddAccount(const std::string& long_name, const std::string& short_n
 
   auto sn = Trim(short_name);
   if (GetAccountByName(sn) != -1) throw "Account already added";
-  auto* a = finans_->add_accounts();
+  finans::Mutation m;
+  auto* a = m.mutable_account();
   a->set_long_name(Trim(long_name));
   a->set_short_name(sn);
 
   a->set_prefered_currency(currency);
+  Record(m);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -83,12 +964,11 @@ int Finans::NumberOfCompanies() const {
 }
 
 int Finans::GetCompanyByName(const std::string& name) const {
-  const auto n = ToLower(name);
-  for (int i = 0; i < finans_->companies_size(); ++i) {
-    if (ToLower(finans_->companies(i).name()) == n) return i;
-  }
+  return companies_.Find(name);
+}
 
-  return -1;
+const std::string& Finans::GetCompanyName(int company) const {
+  return finans_->companies(company).name();
 }
 
 void Finans::AddCompany(const std::string& name, int currency) {
@@ -96,9 +976,11 @@ void Finans::AddCompany(const std::string& name, int currency) {
 
   if (GetCompanyByName(name) != -1) throw "Company already added";
 
-  auto* c = finans_->add_companies();
+  finans::Mutation m;
+  auto* c = m.mutable_company();
   c->set_name(Trim(name));
   c->set_currency(currency);
+  Record(m);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -108,22 +990,27 @@ int Finans::NumberOfCurrencies() const {
 }
 
 int Finans::GetCurrencyByName(const std::string& short_name) const {
-  const auto name = ToLower(short_name);
-  for (int i = 0; i < finans_->currencies_size(); ++i) {
-    if ( ToLower(finans_->currencies(i).short_name()) == name) return i;
-  }
+  return currencies_.Find(short_name);
+}
+
+const std::string& Finans::GetCurrencyName(int currency) const {
+  return finans_->currencies(currency).short_name();
+}
 
-  return -1;
+const MoneyFormat& Finans::GetMoneyFormat(int currency) const {
+  return money_formats_[currency];
 }
 
 void Finans::AddCurency(const std::string& full_name, const std::string& short_name, const std::string before, const std::string& after) {
   const auto sn = Trim(short_name);
   if (GetCurrencyByName(sn) != -1) throw "Currency already added";
-  auto* cur = finans_->add_currencies();
+  finans::Mutation m;
+  auto* cur = m.mutable_currency();
   cur->set_full_name(Trim(full_name));
   cur->set_short_name(sn);
   cur->set_value_before(before);
   cur->set_value_after(after);
+  Record(m);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -133,17 +1020,233 @@ int Finans::NumberOfCategories() const {
 }
 
 int Finans::GetCategoryByName(const std::string& name) const {
-  const auto n = ToLower(name);
-  for (int i = 0; i < finans_->categories_size(); ++i) {
-    if (ToLower(finans_->categories(i).name()) == n) return i;
-  }
+  return categories_.Find(name);
+}
 
-  return -1;
+const std::string& Finans::GetCategoryName(int category) const {
+  return finans_->categories(category).name();
 }
 
 void Finans::AddCategory(const std::string& name) {
   const auto n = Trim(name);
   if (GetCategoryByName(n) != -1) throw "Category already added";
-  auto* c = finans_->add_categories();
+  finans::Mutation m;
+  auto* c = m.mutable_category();
   c->set_name(n);
+  Record(m);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+int Finans::NumberOfExternalExchanges() const {
+  return static_cast<int>(external_.size());
+}
+
+void Finans::AddExternalExchange(int account, int company, int category, int value, int64_t when) {
+  if (account < 0 || account >= NumberOfAccounts()) throw "Invalid account";
+  if (company < 0 || company >= NumberOfCompanies()) throw "Invalid company";
+  if (category < -1 || category >= NumberOfCategories()) throw "Invalid category";
+
+  finans::Mutation m;
+  auto* e = m.mutable_external_exchange();
+  e->set_account(account);
+  e->set_company(company);
+  e->set_category(category);
+  e->set_value(value);
+  e->set_when(when);
+  Record(m);
+}
+
+ExternalExchangeRow Finans::GetExternalExchange(int index) const {
+  ExternalExchangeRow row;
+  row.account = external_.accounts()[index];
+  row.company = external_.companies()[index];
+  row.category = external_.categories()[index];
+  row.value = external_.values()[index];
+  row.when = external_.whens()[index];
+  return row;
+}
+
+TimeIndex::Slice Finans::GetExternalExchangesBetween(int64_t from, int64_t to) const {
+  return external_times_.Range(from, to);
+}
+
+int64_t Finans::SumExternalExchanges(int account, int64_t from, int64_t to) const {
+  return SumValuesWhere(external_.values().data(), external_.accounts().data(), external_.whens().data(),
+                        external_.size(), account, from, to);
+}
+
+std::vector<int> Finans::QueryExternalExchanges(const std::string& text) const {
+  Query query;
+  const auto error = query.Compile(text, FinansQueryNames(*this));
+  if (error.empty() == false) throw "Invalid query: " + error;
+
+  auto found = query.Run(external_);
+  const auto& whens = external_.whens();
+  std::stable_sort(found.begin(), found.end(), [&whens](int lhs, int rhs) {
+    return whens[lhs] < whens[rhs];
+  });
+  return found;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+int Finans::NumberOfInternalExchanges() const {
+  return finans_->internal_exchanges_size();
+}
+
+void Finans::AddInternalExchange(int from_account, int from_currency, int from_value, int to_account, int to_currency, int to_value, int64_t when) {
+  if (from_account < 0 || from_account >= NumberOfAccounts()) throw "Invalid from account";
+  if (to_account < 0 || to_account >= NumberOfAccounts()) throw "Invalid to account";
+  if (from_currency < 0 || from_currency >= NumberOfCurrencies()) throw "Invalid from currency";
+  if (to_currency < 0 || to_currency >= NumberOfCurrencies()) throw "Invalid to currency";
+
+  finans::Mutation m;
+  auto* e = m.mutable_internal_exchange();
+  e->set_from_account(from_account);
+  e->set_from_currency(from_currency);
+  e->set_from_value(from_value);
+  e->set_to_account(to_account);
+  e->set_to_currency(to_currency);
+  e->set_to_value(to_value);
+  e->set_when(when);
+  Record(m);
+}
+
+InternalExchangeRow Finans::GetInternalExchange(int index) const {
+  const auto& e = finans_->internal_exchanges(index);
+  InternalExchangeRow row;
+  row.from_account = e.from_account();
+  row.from_currency = e.from_currency();
+  row.from_value = e.from_value();
+  row.to_account = e.to_account();
+  row.to_currency = e.to_currency();
+  row.to_value = e.to_value();
+  row.when = e.when();
+  return row;
+}
+
+TimeIndex::Slice Finans::GetInternalExchangesBetween(int64_t from, int64_t to) const {
+  return internal_times_.Range(from, to);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+int64_t Finans::GetBalance(int account, int currency) const {
+  return balances_.Get(account, currency);
+}
+
+std::vector<int> Finans::GetBalanceCurrencies(int account) const {
+  return balances_.GetCurrencies(account);
+}
+
+bool Finans::VerifyBalances() const {
+  Balances computed;
+  AddAllToBalances(external_, 0, &computed);
+  for (const auto& e : finans_->internal_exchanges()) {
+    AddToBalances(e, &computed);
+  }
+  return computed == balances_;
+}
+
+int64_t Finans::GetBalanceAt(int account, int currency, int64_t when) const {
+  return history_.GetBalanceBefore(account, currency, when);
+}
+
+int64_t Finans::GetBalanceAt(int account, int currency, const DateTime& when) const {
+  return GetBalanceAt(account, currency, static_cast<int64_t>(DateTimeToInt64(when.time())));
+}
+
+std::vector<int64_t> Finans::GetDailyBalances(int account, int currency, Day first_day, int days) const {
+  if (days < 0) throw "Invalid number of days";
+  std::vector<int64_t> ends;
+  ends.reserve(days);
+  for (int day = 1; day <= days; ++day) {
+    ends.push_back((first_day + day).LocalStart(&local_time_));
+  }
+  return history_.GetBalancesBefore(account, currency, ends);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+EnvelopeReport Finans::ReportEnvelopes(int threads) const {
+  EnvelopeReport report;
+  const auto all = external_times_.All();
+  if (all.empty()) return report;
+  report.months = MonthsBetween(&local_time_, external_.whens()[*all.begin()], external_.whens()[*(all.end() - 1)]);
+
+  ThreadPool pool(threads);
+  // a few chunks per thread so a slow thread doesn't hold everyone up
+  const auto size = external_.size();
+  const auto chunks = std::min<std::size_t>(size, static_cast<std::size_t>(pool.size()) * 4);
+  std::vector<EnvelopeAccumulator> sums(chunks);
+  for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+    pool.Add([this, &report, &sums, chunk, chunks, size]() {
+      const auto begin = size * chunk / chunks;
+      const auto end = size * (chunk + 1) / chunks;
+      auto& sum = sums[chunk];
+      const auto& whens = external_.whens();
+      const auto& categories = external_.categories();
+      const auto& currencies = external_.currencies();
+      const auto& values = external_.values();
+      for (auto i = begin; i < end; ++i) {
+        sum.Add(FindMonth(report.months, whens[i]), categories[i], currencies[i], values[i]);
+      }
+    });
+  }
+  pool.Wait();
+
+  for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+    sums[0].Merge(sums[chunk]);
+  }
+  report.rows = sums[0].GetRows();
+  return report;
+}
+
+const MonthlySummaries& Finans::GetMonthlySummaries() {
+  RefreshSummaries();
+  return summaries_;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void Finans::AddRate(int from_currency, int to_currency, double rate, int64_t when) {
+  if (from_currency < 0 || from_currency >= NumberOfCurrencies()) throw "Invalid from currency";
+  if (to_currency < 0 || to_currency >= NumberOfCurrencies()) throw "Invalid to currency";
+  if (from_currency == to_currency) throw "A rate needs two different currencies";
+  if (!(rate > 0)) throw "Rate must be positive";
+
+  finans::Mutation m;
+  auto* r = m.mutable_rate();
+  r->set_from_currency(from_currency);
+  r->set_to_currency(to_currency);
+  r->set_rate(rate);
+  r->set_when(when);
+  Record(m);
+}
+
+bool Finans::GetRate(int from_currency, int to_currency, int64_t when, double* rate) const {
+  return rates_.GetRate(from_currency, to_currency, when, rate);
+}
+
+bool Finans::ConvertExternalExchanges(int currency, std::vector<int64_t>* values) const {
+  values->resize(external_.size());
+  if (external_.empty()) return true;
+  return ConvertValuesAt(rates_, NumberOfCurrencies(), currency, external_.currencies().data(),
+                         external_.values().data(), external_.whens().data(), external_.size(), values->data());
+}
+
+int64_t Finans::GetNetWorth(int currency, int64_t when) const {
+  // when is usually the midnight that starts the next day
+  const auto& matrix = rates_.GetMatrix(NumberOfCurrencies(), when - 1);
+  int64_t sum = 0;
+  for (int account = 0; account < NumberOfAccounts(); ++account) {
+    for (const auto c : GetBalanceCurrencies(account)) {
+      const auto balance = GetBalanceAt(account, c, when);
+      if (balance == 0) continue;
+      if (matrix.Has(c, currency) == false) throw "No rate from " + GetCurrencyName(c) + " to " + GetCurrencyName(currency);
+      sum += static_cast<int64_t>(std::floor(balance * matrix.Get(c, currency) + 0.5));
+    }
+  }
+  return sum;
 }
@@ -3,48 +3,249 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <cstdint>
+
+#include "finans/core/balancehistory.h"
+#include "finans/core/balances.h"
+#include "finans/core/csvimport.h"
+#include "finans/core/datetime.h"
+#include "finans/core/day.h"
+#include "finans/core/envelopes.h"
+#include "finans/core/exchangecolumns.h"
+#include "finans/core/moneyformat.h"
+#include "finans/core/nameindex.h"
+#include "finans/core/rates.h"
+#include "finans/core/reconcile.h"
+#include "finans/core/rules.h"
+#include "finans/core/summaries.h"
+#include "finans/core/timeindex.h"
 
 namespace finans {
   class Finans;
+  class Mutation;
 }
 
+enum class SnapshotFormat {
+  JSON, BINARY
+};
+
+// from a company to a account or the other way around, value is in cents
+// of the prefered currency of the account
+struct ExternalExchangeRow {
+  int account;
+  int company;
+  int category;
+  int value;
+  int64_t when;
+};
+
+// between accounts
+struct InternalExchangeRow {
+  int from_account;
+  int from_currency;
+  int from_value;
+  int to_account;
+  int to_currency;
+  int to_value;
+  int64_t when;
+};
+
+// where the time went during the last Load, in milliseconds
+struct LoadTiming {
+  LoadTiming();
+
+  bool cache_enabled;
+  bool cache_hit;
+  double snapshot;
+  double journal;
+  int journal_records;
+  double total;
+};
+
 class Finans {
 public:
   /* Construction */
   static std::shared_ptr<Finans> CreateNew();
+  // loads the snapshot at path without looking at the configuration, the
+  // journal is next to it. a empty cache_path doesn't use the cache
+  static std::shared_ptr<Finans> Open(const std::string& path, SnapshotFormat format, const std::string& cache_path, uint64_t journal_compact_size);
   static void CreateDefault(const std::string& src);
   static void Install(const std::string& path, bool create_if_missing);
+  static void Convert(SnapshotFormat format);
 
   ~Finans();
 
 public:
+  // load the snapshot and replay the journal on top of it
   void Load();
+  // append the changes since the last save to the journal, and fold the
+  // journal into the snapshot when it has grown too large
   void Save();
+  // write a new snapshot and start a empty journal
+  void Compact();
+
+  const LoadTiming& load_timing() const;
+  // if the snapshot or journal has been written by someone else since it
+  // was loaded or saved, like another fin or a sync
+  bool IsChangedOnDisk() const;
+
+  // json is kept around as the interchange format
+  void ImportJson(const std::string& path);
+  void ExportJson(const std::string& path) const;
+  // adds the exchanges of a bank statement to the account, payees that
+  // aren't companies are added as companies. returns the number of exchanges.
+  // if reconcile isn't null the statement is compared to the ledger first and
+  // only the new exchanges are added. if rules isn't null they decide the
+  // company and category of every exchange and count their hits
+  int ImportCsv(const std::string& path, int account, const CsvFormat& format, int threads, Rules* rules, ReconcileReport* reconcile);
 
 public:
   int NumberOfAccounts() const;
   int GetAccountByName(const std::string& short_name) const;
+  const std::string& GetAccountName(int account) const;
+  int GetAccountCurrency(int account) const;
   void AddAccount(const std::string& long_name, const std::string& short_name, int currency);
 
 public:
   int NumberOfCompanies() const;
   int GetCompanyByName(const std::string& name) const;
+  const std::string& GetCompanyName(int company) const;
   void AddCompany(const std::string& name, int currency);
 
 public:
   int NumberOfCurrencies() const;
   int GetCurrencyByName(const std::string& short_name) const;
+  const std::string& GetCurrencyName(int currency) const;
+  // the before and after of the currency, or the short name after the value
+  // if the currency has neither
+  const MoneyFormat& GetMoneyFormat(int currency) const;
   void AddCurency(const std::string& full_name, const std::string& short_name, const std::string before, const std::string& after);
 
 public:
   int NumberOfCategories() const;
   int GetCategoryByName(const std::string& name) const;
+  const std::string& GetCategoryName(int category) const;
   void AddCategory(const std::string& name);
 
+public:
+  int NumberOfExternalExchanges() const;
+  // category can be -1 for uncategorized
+  void AddExternalExchange(int account, int company, int category, int value, int64_t when);
+  ExternalExchangeRow GetExternalExchange(int index) const;
+  // indices of the exchanges where from <= when < to, ordered by when
+  TimeIndex::Slice GetExternalExchangesBetween(int64_t from, int64_t to) const;
+  // sum of the external exchanges of the account where from <= when < to
+  int64_t SumExternalExchanges(int account, int64_t from, int64_t to) const;
+  // the external exchanges matching the query, see query.h, ordered by when
+  std::vector<int> QueryExternalExchanges(const std::string& query) const;
+
+  int NumberOfInternalExchanges() const;
+  void AddInternalExchange(int from_account, int from_currency, int from_value, int to_account, int to_currency, int to_value, int64_t when);
+  InternalExchangeRow GetInternalExchange(int index) const;
+  TimeIndex::Slice GetInternalExchangesBetween(int64_t from, int64_t to) const;
+
+public:
+  // the running balance of the account, in cents
+  int64_t GetBalance(int account, int currency) const;
+  std::vector<int> GetBalanceCurrencies(int account) const;
+  // recompute all balances from the exchanges and compare with the running balances
+  bool VerifyBalances() const;
+
+  // the balance from all exchanges before the time
+  int64_t GetBalanceAt(int account, int currency, int64_t when) const;
+  int64_t GetBalanceAt(int account, int currency, const DateTime& when) const;
+  // the balance at the end of each day, starting with the day of first_day
+  std::vector<int64_t> GetDailyBalances(int account, int currency, Day first_day, int days) const;
+
+public:
+  // the external exchanges summed per category, month and currency.
+  // the exchanges are split in chunks and summed on threads, below 1 uses all cores
+  EnvelopeReport ReportEnvelopes(int threads) const;
+
+  // recomputes the months changed since the last call
+  const MonthlySummaries& GetMonthlySummaries();
+
+public:
+  // one from is worth rate to from when and on.
+  // internal exchanges between currencies are also used as rates
+  void AddRate(int from_currency, int to_currency, double rate, int64_t when);
+  bool GetRate(int from_currency, int to_currency, int64_t when, double* rate) const;
+  // the value of every external exchange in the currency, at the rate of its day.
+  // returns false if a currency is missing a rate, those values are 0
+  bool ConvertExternalExchanges(int currency, std::vector<int64_t>* values) const;
+  // the sum of all balances before when, in the currency at the rates of the
+  // day the last second before when is in, so the end of a day uses its own rates
+  int64_t GetNetWorth(int currency, int64_t when) const;
+
 private:
-  Finans(const std::string& path);
+  Finans(const std::string& path, SnapshotFormat format);
+  void Apply(const finans::Mutation& mutation);
+  // applies the mutations in order, runs of external exchanges are added as
+  // one batch so a statement in any order is sorted in once
+  void ApplyAll(const std::vector<finans::Mutation>& mutations);
+  void ApplyExternalExchanges(const finans::Mutation* begin, const finans::Mutation* end);
+  void RebuildIndexes();
+  void RebuildHistory();
+  void RebuildRates();
+  void ReconcileAgainstLedger(ReconcileReport* report) const;
+  void LoadBalances();
+  void StoreBalances();
+  // moves the external exchanges from the proto to the columns
+  void TakeExternalExchanges();
+  // uses the stored summaries if they match the exchanges, otherwise rebuilds them
+  void LoadSummaries();
+  void RebuildSummaries();
+  void RefreshSummaries();
+  void StoreSummaries();
+  void Record(const finans::Mutation& mutation);
+  void RecordAll(const std::vector<finans::Mutation>& mutations);
+
+  // size and modification time of the snapshot and journal, -1 if missing
+  struct DiskState {
+    int64_t snapshot_size;
+    int64_t snapshot_modified;
+    int64_t journal_size;
+    int64_t journal_modified;
+  };
+  DiskState ReadDiskState() const;
+
   std::string path_;
+  std::string journal_path_;
+  std::string cache_path_;
+  LoadTiming load_timing_;
+  SnapshotFormat format_;
+  // everything but the external exchanges, they live in external_ and are
+  // only written to the proto while saving
   std::unique_ptr<finans::Finans> finans_;
+  ExchangeColumns external_;
+  // changes with every external exchange, used to validate the stored summaries
+  uint64_t external_fingerprint_;
+
+  NameIndex accounts_;
+  NameIndex companies_;
+  NameIndex currencies_;
+  NameIndex categories_;
+  std::vector<MoneyFormat> money_formats_;
+  TimeIndex external_times_;
+  TimeIndex internal_times_;
+  Balances balances_;
+  BalanceHistory history_;
+  MonthlySummaries summaries_;
+  RateTable rates_;
+  // day and month starts for the balances, summaries and reports, only used
+  // on the calling thread
+  mutable UtcOffsetTable local_time_;
+
+  // serialized mutations that hasn't been written to the journal yet
+  std::vector<std::string> pending_;
+  uint64_t journal_size_;
+  uint64_t journal_limit_;
+  bool needs_compaction_;
+  // set when the journal couldn't be read, saving would lose what is in it
+  bool journal_damaged_;
+  // the files as they were after our last load or save
+  DiskState disk_state_;
 };
 
 #endif
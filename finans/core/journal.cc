@@ -0,0 +1,143 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/journal.h"
+
+#include <algorithm>
+#include <fstream>  // NOLINT this is how we use fstrean
+
+namespace {
+const char JOURNAL_MAGIC[] = { 'F', 'I', 'N', 'J', 'R', 'N', 'L', '1' };
+const std::size_t JOURNAL_MAGIC_SIZE = sizeof(JOURNAL_MAGIC);
+const std::size_t HEADER_SIZE = JOURNAL_MAGIC_SIZE + 8;
+const std::size_t RECORD_HEADER_SIZE = 8;
+
+// fnv-1a, only used to detect torn writes
+uint32_t Checksum(const char* data, std::size_t size) {
+  uint32_t hash = 2166136261u;
+  for (std::size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+void WriteUint(std::string* dest, uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; ++i) {
+    dest->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+uint64_t ReadUint(const char* src, int bytes) {
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i) {
+    value |= static_cast<uint64_t>(static_cast<unsigned char>(src[i])) << (8 * i);
+  }
+  return value;
+}
+
+// true if a complete record starts anywhere after offset. a torn write is
+// the end of the file, so finding a record after it means it's damaged
+bool HasRecordAfter(const std::string& data, std::size_t offset) {
+  for (auto start = offset + 1; data.size() - start >= RECORD_HEADER_SIZE; ++start) {
+    const auto size = static_cast<std::size_t>(ReadUint(data.data() + start, 4));
+    if (data.size() - start - RECORD_HEADER_SIZE < size) continue;
+    const auto checksum = static_cast<uint32_t>(ReadUint(data.data() + start + 4, 4));
+    if (Checksum(data.data() + start + RECORD_HEADER_SIZE, size) == checksum) return true;
+  }
+  return false;
+}
+}  // namespace
+
+JournalContent::JournalContent()
+  : exists(false), generation(0), valid_size(0), file_size(0) {
+}
+
+std::string ReadJournal(const std::string& path, JournalContent* content) {
+  *content = JournalContent();
+
+  std::ifstream f(path.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+  if (!f) return "";  // no journal is a empty journal
+
+  std::string data(static_cast<std::size_t>(f.tellg()), '\0');
+  f.seekg(0, std::ios::beg);
+  if (data.empty() == false) f.read(&data[0], data.size());
+  if (!f) return "Unable to read journal";
+
+  content->file_size = data.size();
+  if (data.size() < HEADER_SIZE ||
+      false == std::equal(JOURNAL_MAGIC, JOURNAL_MAGIC + JOURNAL_MAGIC_SIZE, data.data())) {
+    return "";
+  }
+  content->exists = true;
+  content->generation = static_cast<int64_t>(ReadUint(data.data() + JOURNAL_MAGIC_SIZE, 8));
+
+  std::size_t offset = HEADER_SIZE;
+  while (data.size() - offset >= RECORD_HEADER_SIZE) {
+    const auto size = static_cast<std::size_t>(ReadUint(data.data() + offset, 4));
+    const auto checksum = static_cast<uint32_t>(ReadUint(data.data() + offset + 4, 4));
+    const char* payload = data.data() + offset + RECORD_HEADER_SIZE;
+    const auto end = offset + RECORD_HEADER_SIZE + size;
+    if (data.size() - offset - RECORD_HEADER_SIZE < size) {
+      // a short record is either torn or has a damaged size
+      if (HasRecordAfter(data, offset) == false) break;
+      content->valid_size = offset;
+      return "Corrupt record size at byte " + std::to_string(offset);
+    }
+    if (Checksum(payload, size) != checksum) {
+      // only the last record can be torn, anything after it means the
+      // journal is damaged and the later records can't be trusted either
+      if (end == data.size()) break;
+      content->valid_size = offset;
+      return "Corrupt record at byte " + std::to_string(offset);
+    }
+
+    content->records.push_back(std::string(payload, size));
+    offset += RECORD_HEADER_SIZE + size;
+  }
+  content->valid_size = offset;
+
+  return "";
+}
+
+std::string ResetJournal(const std::string& path, int64_t generation) {
+  std::string header(JOURNAL_MAGIC, JOURNAL_MAGIC_SIZE);
+  WriteUint(&header, static_cast<uint64_t>(generation), 8);
+
+  std::ofstream f(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!f) return "Unable to write journal";
+  f.write(header.data(), header.size());
+  if (!f) return "Unable to write journal";
+
+  return "";
+}
+
+uint64_t EmptyJournalSize() {
+  return HEADER_SIZE;
+}
+
+uint64_t JournalRecordsSize(const std::vector<std::string>& records) {
+  uint64_t size = 0;
+  for (const auto& payload : records) {
+    size += RECORD_HEADER_SIZE + payload.size();
+  }
+  return size;
+}
+
+std::string AppendJournal(const std::string& path, const std::vector<std::string>& records, uint64_t* written) {
+  // build everything first so the file gets a single write
+  std::string data;
+  for (const auto& payload : records) {
+    WriteUint(&data, payload.size(), 4);
+    WriteUint(&data, Checksum(payload.data(), payload.size()), 4);
+    data += payload;
+  }
+
+  std::ofstream f(path.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+  if (!f) return "Unable to open journal";
+  f.write(data.data(), data.size());
+  f.flush();
+  if (!f) return "Unable to write journal";
+
+  if (written) *written = data.size();
+  return "";
+}
@@ -0,0 +1,51 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_JOURNAL_H_
+#define CORE_JOURNAL_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+The journal is an append only file of mutations that are applied on top of
+the last snapshot, so a save only costs the size of the change.
+
+It starts with a header containing the generation of the snapshot it belongs
+to, followed by records of: size (4 bytes), checksum (4 bytes), data. The data
+is a serialized finans::Mutation but the journal itself doesn't care.
+A record that was only partially written (crash, full disk) is short or
+fails the checksum and ends the journal. Only the last record can be torn,
+a record in the middle that fails the checksum or has a size past the end
+of the file is a error.
+*/
+
+struct JournalContent {
+  JournalContent();
+
+  bool exists;
+  int64_t generation;
+  std::vector<std::string> records;
+
+  // bytes of the file that could be read, anything after this is garbage
+  uint64_t valid_size;
+  uint64_t file_size;
+};
+
+// a missing journal, or one without a valid header, is read as not existing.
+// returns a error if a record before the last one is damaged
+std::string ReadJournal(const std::string& path, JournalContent* content);
+
+// creates a empty journal for the snapshot generation, replaces any old journal
+std::string ResetJournal(const std::string& path, int64_t generation);
+
+// size of a journal without records
+uint64_t EmptyJournalSize();
+
+// bytes the records take up when appended to a journal
+uint64_t JournalRecordsSize(const std::vector<std::string>& records);
+
+// returns the number of bytes written in written, if not null
+std::string AppendJournal(const std::string& path, const std::vector<std::string>& records, uint64_t* written);
+
+#endif  // CORE_JOURNAL_H_
@@ -0,0 +1,300 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/kernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FINANS_KERNELS_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// msvc can use any intrinsic anywhere, gcc and clang needs to be told
+// that a function may use avx2 without enabling it for the whole file
+#if defined(FINANS_KERNELS_X64) && (defined(__GNUC__) || defined(__clang__))
+#define FINANS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define FINANS_TARGET_AVX2
+#endif
+
+namespace {
+const int64_t SECONDS_PER_DAY = 24 * 60 * 60;
+// the simd versions divide as double and truncate, the bias makes every
+// supported when positive so truncating is rounding down
+const int64_t BIAS_DAYS = 1 << 20;
+
+int64_t SumValuesScalar(const int* values, std::size_t count) {
+  int64_t sum = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    sum += values[i];
+  }
+  return sum;
+}
+
+int64_t SumValuesWhereScalar(const int* values, const int* accounts, const int64_t* whens, std::size_t count,
+                             int account, int64_t from, int64_t to) {
+  int64_t sum = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (accounts[i] == account && from <= whens[i] && whens[i] < to) sum += values[i];
+  }
+  return sum;
+}
+
+void SecondsToDaysScalar(const int64_t* seconds, std::size_t count, int32_t* days) {
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto s = seconds[i];
+    days[i] = static_cast<int32_t>((s >= 0 ? s : s - SECONDS_PER_DAY + 1) / SECONDS_PER_DAY);
+  }
+}
+
+#ifdef FINANS_KERNELS_X64
+// sse2 is part of x64 so these don't need any detection
+
+// there is no int64 to double conversion before avx512, but adding 1.5 * 2^52
+// as integers puts a integer below 2^51 in the mantissa of that double
+const int64_t MAGIC_BITS = 0x4338000000000000ll;
+const double MAGIC = 6755399441055744.0;
+
+int64_t HorizontalSum(__m128i v) {
+  const auto high = _mm_unpackhi_epi64(v, v);
+  return _mm_cvtsi128_si64(_mm_add_epi64(v, high));
+}
+
+// sign extends the 4 int32 into 2 + 2 int64
+void Widen(__m128i v, __m128i* low, __m128i* high) {
+  const auto sign = _mm_cmpgt_epi32(_mm_setzero_si128(), v);
+  *low = _mm_unpacklo_epi32(v, sign);
+  *high = _mm_unpackhi_epi32(v, sign);
+}
+
+// sse2 has no 64 bit compare, compare the high halves signed and the low
+// halves unsigned and combine them
+__m128i GreaterThan64(__m128i a, __m128i b) {
+  const auto flip = _mm_set_epi32(0, static_cast<int>(0x80000000), 0, static_cast<int>(0x80000000));
+  const auto gt = _mm_cmpgt_epi32(_mm_xor_si128(a, flip), _mm_xor_si128(b, flip));
+  const auto eq = _mm_cmpeq_epi32(a, b);
+  const auto gt_high = _mm_shuffle_epi32(gt, _MM_SHUFFLE(3, 3, 1, 1));
+  const auto gt_low = _mm_shuffle_epi32(gt, _MM_SHUFFLE(2, 2, 0, 0));
+  const auto eq_high = _mm_shuffle_epi32(eq, _MM_SHUFFLE(3, 3, 1, 1));
+  return _mm_or_si128(gt_high, _mm_and_si128(eq_high, gt_low));
+}
+
+int64_t SumValuesSse2(const int* values, std::size_t count) {
+  auto sum = _mm_setzero_si128();
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i low;
+    __m128i high;
+    Widen(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)), &low, &high);
+    sum = _mm_add_epi64(sum, _mm_add_epi64(low, high));
+  }
+  return HorizontalSum(sum) + SumValuesScalar(values + i, count - i);
+}
+
+int64_t SumValuesWhereSse2(const int* values, const int* accounts, const int64_t* whens, std::size_t count,
+                           int account, int64_t from, int64_t to) {
+  const auto wanted = _mm_set1_epi32(account);
+  const auto from_v = _mm_set1_epi64x(from);
+  const auto to_v = _mm_set1_epi64x(to);
+  auto sum = _mm_setzero_si128();
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const auto same = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(accounts + i)), wanted);
+    const auto when_low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(whens + i));
+    const auto when_high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(whens + i + 2));
+    // from <= when is !(from > when)
+    const auto in_low = _mm_andnot_si128(GreaterThan64(from_v, when_low), GreaterThan64(to_v, when_low));
+    const auto in_high = _mm_andnot_si128(GreaterThan64(from_v, when_high), GreaterThan64(to_v, when_high));
+
+    __m128i low;
+    __m128i high;
+    Widen(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)), &low, &high);
+    const auto mask_low = _mm_and_si128(_mm_unpacklo_epi32(same, same), in_low);
+    const auto mask_high = _mm_and_si128(_mm_unpackhi_epi32(same, same), in_high);
+    sum = _mm_add_epi64(sum, _mm_and_si128(low, mask_low));
+    sum = _mm_add_epi64(sum, _mm_and_si128(high, mask_high));
+  }
+  return HorizontalSum(sum) +
+    SumValuesWhereScalar(values + i, accounts + i, whens + i, count - i, account, from, to);
+}
+
+__m128i SecondsToDays2(__m128i seconds) {
+  const auto biased = _mm_add_epi64(seconds, _mm_set1_epi64x(BIAS_DAYS * SECONDS_PER_DAY + MAGIC_BITS));
+  const auto value = _mm_sub_pd(_mm_castsi128_pd(biased), _mm_set1_pd(MAGIC));
+  return _mm_cvttpd_epi32(_mm_div_pd(value, _mm_set1_pd(static_cast<double>(SECONDS_PER_DAY))));
+}
+
+void SecondsToDaysSse2(const int64_t* seconds, std::size_t count, int32_t* days) {
+  const auto bias = _mm_set1_epi32(static_cast<int>(BIAS_DAYS));
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const auto low = SecondsToDays2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(seconds + i)));
+    const auto high = SecondsToDays2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(seconds + i + 2)));
+    const auto d = _mm_sub_epi32(_mm_unpacklo_epi64(low, high), bias);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(days + i), d);
+  }
+  SecondsToDaysScalar(seconds + i, count - i, days + i);
+}
+
+FINANS_TARGET_AVX2
+int64_t HorizontalSum(__m256i v) {
+  const auto folded = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  return _mm_cvtsi128_si64(_mm_add_epi64(folded, _mm_unpackhi_epi64(folded, folded)));
+}
+
+FINANS_TARGET_AVX2
+int64_t SumValuesAvx2(const int* values, std::size_t count) {
+  auto sum = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+    sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+    sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+  }
+  return HorizontalSum(sum) + SumValuesScalar(values + i, count - i);
+}
+
+FINANS_TARGET_AVX2
+int64_t SumValuesWhereAvx2(const int* values, const int* accounts, const int64_t* whens, std::size_t count,
+                           int account, int64_t from, int64_t to) {
+  const auto wanted = _mm256_set1_epi32(account);
+  const auto from_v = _mm256_set1_epi64x(from);
+  const auto to_v = _mm256_set1_epi64x(to);
+  auto sum = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const auto same = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(accounts + i)), wanted);
+    const auto when_low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(whens + i));
+    const auto when_high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(whens + i + 4));
+    const auto in_low = _mm256_andnot_si256(_mm256_cmpgt_epi64(from_v, when_low), _mm256_cmpgt_epi64(to_v, when_low));
+    const auto in_high = _mm256_andnot_si256(_mm256_cmpgt_epi64(from_v, when_high), _mm256_cmpgt_epi64(to_v, when_high));
+
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+    const auto mask_low = _mm256_and_si256(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(same)), in_low);
+    const auto mask_high = _mm256_and_si256(_mm256_cvtepi32_epi64(_mm256_extracti128_si256(same, 1)), in_high);
+    sum = _mm256_add_epi64(sum, _mm256_and_si256(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)), mask_low));
+    sum = _mm256_add_epi64(sum, _mm256_and_si256(_mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)), mask_high));
+  }
+  return HorizontalSum(sum) +
+    SumValuesWhereScalar(values + i, accounts + i, whens + i, count - i, account, from, to);
+}
+
+FINANS_TARGET_AVX2
+void SecondsToDaysAvx2(const int64_t* seconds, std::size_t count, int32_t* days) {
+  const auto offset = _mm256_set1_epi64x(BIAS_DAYS * SECONDS_PER_DAY + MAGIC_BITS);
+  const auto magic = _mm256_set1_pd(MAGIC);
+  const auto divisor = _mm256_set1_pd(static_cast<double>(SECONDS_PER_DAY));
+  const auto bias = _mm_set1_epi32(static_cast<int>(BIAS_DAYS));
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const auto biased = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(seconds + i)), offset);
+    const auto value = _mm256_sub_pd(_mm256_castsi256_pd(biased), magic);
+    const auto d = _mm_sub_epi32(_mm256_cvttpd_epi32(_mm256_div_pd(value, divisor)), bias);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(days + i), d);
+  }
+  SecondsToDaysScalar(seconds + i, count - i, days + i);
+}
+
+bool CpuHasAvx2() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) return false;
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  // the os must save the ymm registers on a context switch
+  if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif  // FINANS_KERNELS_X64
+
+KernelLevel Detect() {
+#ifdef FINANS_KERNELS_X64
+  return CpuHasAvx2() ? KernelLevel::AVX2 : KernelLevel::SSE2;
+#else
+  return KernelLevel::SCALAR;
+#endif
+}
+}  // namespace
+
+KernelLevel DetectKernelLevel() {
+  static const KernelLevel level = Detect();
+  return level;
+}
+
+const char* KernelLevelName(KernelLevel level) {
+  switch (level) {
+  case KernelLevel::AVX2:
+    return "avx2";
+  case KernelLevel::SSE2:
+    return "sse2";
+  default:
+    return "scalar";
+  }
+}
+
+int64_t SumValues(const int* values, std::size_t count) {
+  return SumValues(DetectKernelLevel(), values, count);
+}
+
+int64_t SumValues(KernelLevel level, const int* values, std::size_t count) {
+  // a level the cpu doesn't support falls back to the best one it does
+  if (level > DetectKernelLevel()) level = DetectKernelLevel();
+  switch (level) {
+#ifdef FINANS_KERNELS_X64
+  case KernelLevel::AVX2:
+    return SumValuesAvx2(values, count);
+  case KernelLevel::SSE2:
+    return SumValuesSse2(values, count);
+#endif
+  default:
+    return SumValuesScalar(values, count);
+  }
+}
+
+int64_t SumValuesWhere(const int* values, const int* accounts, const int64_t* whens, std::size_t count,
+                       int account, int64_t from, int64_t to) {
+  return SumValuesWhere(DetectKernelLevel(), values, accounts, whens, count, account, from, to);
+}
+
+int64_t SumValuesWhere(KernelLevel level, const int* values, const int* accounts, const int64_t* whens, std::size_t count,
+                       int account, int64_t from, int64_t to) {
+  if (level > DetectKernelLevel()) level = DetectKernelLevel();
+  switch (level) {
+#ifdef FINANS_KERNELS_X64
+  case KernelLevel::AVX2:
+    return SumValuesWhereAvx2(values, accounts, whens, count, account, from, to);
+  case KernelLevel::SSE2:
+    return SumValuesWhereSse2(values, accounts, whens, count, account, from, to);
+#endif
+  default:
+    return SumValuesWhereScalar(values, accounts, whens, count, account, from, to);
+  }
+}
+
+void SecondsToDays(const int64_t* seconds, std::size_t count, int32_t* days) {
+  SecondsToDays(DetectKernelLevel(), seconds, count, days);
+}
+
+void SecondsToDays(KernelLevel level, const int64_t* seconds, std::size_t count, int32_t* days) {
+  if (level > DetectKernelLevel()) level = DetectKernelLevel();
+  switch (level) {
+#ifdef FINANS_KERNELS_X64
+  case KernelLevel::AVX2:
+    SecondsToDaysAvx2(seconds, count, days);
+    return;
+  case KernelLevel::SSE2:
+    SecondsToDaysSse2(seconds, count, days);
+    return;
+#endif
+  default:
+    SecondsToDaysScalar(seconds, count, days);
+    return;
+  }
+}
@@ -0,0 +1,36 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_KERNELS_H_
+#define CORE_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// the inner loops of the reports, run over the exchange columns.
+// the int32 values are widened to int64 before they are summed so a sum of
+// many cent values can't overflow.
+
+enum class KernelLevel {
+  SCALAR, SSE2, AVX2
+};
+
+// the best level this cpu supports, detected once
+KernelLevel DetectKernelLevel();
+const char* KernelLevelName(KernelLevel level);
+
+// sum of all values
+int64_t SumValues(const int* values, std::size_t count);
+int64_t SumValues(KernelLevel level, const int* values, std::size_t count);
+
+// sum of values[i] where accounts[i] == account and from <= whens[i] < to
+int64_t SumValuesWhere(const int* values, const int* accounts, const int64_t* whens, std::size_t count,
+                       int account, int64_t from, int64_t to);
+int64_t SumValuesWhere(KernelLevel level, const int* values, const int* accounts, const int64_t* whens, std::size_t count,
+                       int account, int64_t from, int64_t to);
+
+// days[i] is seconds[i] / 86400 rounded down, the day number of a when.
+// exact for whens after the year -900
+void SecondsToDays(const int64_t* seconds, std::size_t count, int32_t* days);
+void SecondsToDays(KernelLevel level, const int64_t* seconds, std::size_t count, int32_t* days);
+
+#endif  // CORE_KERNELS_H_
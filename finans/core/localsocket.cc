@@ -0,0 +1,191 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/localsocket.h"
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef FINANS_UNIX
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// a single command line or its output will never be near this
+const uint32_t MAX_MESSAGE_SIZE = 256 * 1024 * 1024;
+
+#ifdef FINANS_UNIX
+bool MakeAddress(const std::string& path, sockaddr_un* address) {
+  memset(address, 0, sizeof(sockaddr_un));
+  address->sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address->sun_path)) return false;
+  memcpy(address->sun_path, path.c_str(), path.size());
+  return true;
+}
+
+bool WriteAll(int fd, const char* data, std::size_t size) {
+#ifdef MSG_NOSIGNAL
+  const int flags = MSG_NOSIGNAL;
+#else
+  const int flags = 0;
+#endif
+  while (size > 0) {
+    const auto written = send(fd, data, size, flags);
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return false;
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+bool ReadAll(int fd, char* data, std::size_t size) {
+  while (size > 0) {
+    const auto read = recv(fd, data, size, 0);
+    if (read < 0 && errno == EINTR) continue;
+    if (read <= 0) return false;
+    data += read;
+    size -= static_cast<std::size_t>(read);
+  }
+  return true;
+}
+#endif
+}  // namespace
+
+LocalConnection::LocalConnection() : fd_(-1) {
+}
+
+LocalConnection::~LocalConnection() {
+  Close();
+}
+
+bool LocalConnection::is_open() const {
+  return fd_ >= 0;
+}
+
+void LocalConnection::Close() {
+#ifdef FINANS_UNIX
+  if (fd_ >= 0) close(fd_);
+#endif
+  fd_ = -1;
+}
+
+bool LocalConnection::Send(const std::string& message) {
+#ifdef FINANS_UNIX
+  if (fd_ < 0 || message.size() > MAX_MESSAGE_SIZE) return false;
+  const auto size = static_cast<uint32_t>(message.size());
+  const char header[4] = {
+    static_cast<char>(size & 0xFF), static_cast<char>((size >> 8) & 0xFF),
+    static_cast<char>((size >> 16) & 0xFF), static_cast<char>((size >> 24) & 0xFF)
+  };
+  return WriteAll(fd_, header, 4) && WriteAll(fd_, message.data(), message.size());
+#else
+  return false;
+#endif
+}
+
+bool LocalConnection::Receive(std::string* message) {
+#ifdef FINANS_UNIX
+  if (fd_ < 0) return false;
+  unsigned char header[4];
+  if (false == ReadAll(fd_, reinterpret_cast<char*>(header), 4)) return false;
+  const uint32_t size = header[0] | (header[1] << 8) | (header[2] << 16) | (static_cast<uint32_t>(header[3]) << 24);
+  if (size > MAX_MESSAGE_SIZE) return false;
+  message->resize(size);
+  if (size == 0) return true;
+  return ReadAll(fd_, &(*message)[0], size);
+#else
+  return false;
+#endif
+}
+
+bool LocalConnection::SetReceiveTimeout(int seconds) {
+#ifdef FINANS_UNIX
+  if (fd_ < 0) return false;
+  timeval timeout;
+  timeout.tv_sec = seconds;
+  timeout.tv_usec = 0;
+  return setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0;
+#else
+  return false;
+#endif
+}
+
+bool ConnectLocal(const std::string& path, LocalConnection* connection) {
+  connection->Close();
+#ifdef FINANS_UNIX
+  sockaddr_un address;
+  if (false == MakeAddress(path, &address)) return false;
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return false;
+  if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+    close(fd);
+    return false;
+  }
+  connection->fd_ = fd;
+  return true;
+#else
+  return false;
+#endif
+}
+
+LocalServer::LocalServer() : fd_(-1) {
+}
+
+LocalServer::~LocalServer() {
+  Close();
+}
+
+std::string LocalServer::Listen(const std::string& path) {
+  Close();
+#ifdef FINANS_UNIX
+  sockaddr_un address;
+  if (false == MakeAddress(path, &address)) return "Socket path too long: " + path;
+
+  // a socket file without anyone listening is left from a server that died
+  LocalConnection existing;
+  if (ConnectLocal(path, &existing)) return "Server already running on " + path;
+  unlink(path.c_str());
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return "Unable to create socket";
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, 16) != 0) {
+    close(fd);
+    return "Unable to listen on " + path;
+  }
+  fd_ = fd;
+  path_ = path;
+  return "";
+#else
+  return "Local sockets are not supported on this platform";
+#endif
+}
+
+bool LocalServer::Accept(LocalConnection* connection) {
+  connection->Close();
+#ifdef FINANS_UNIX
+  while (fd_ >= 0) {
+    const int fd = accept(fd_, nullptr, nullptr);
+    if (fd < 0 && errno == EINTR) continue;
+    if (fd < 0) return false;
+    connection->fd_ = fd;
+    return true;
+  }
+#endif
+  return false;
+}
+
+void LocalServer::Close() {
+#ifdef FINANS_UNIX
+  if (fd_ >= 0) {
+    close(fd_);
+    unlink(path_.c_str());
+  }
+#endif
+  fd_ = -1;
+  path_ = "";
+}
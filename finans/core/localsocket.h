@@ -0,0 +1,53 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_LOCALSOCKET_H_
+#define CORE_LOCALSOCKET_H_
+
+#include <string>
+
+// a connected local stream socket (unix domain socket),
+// each message is sent with its size in front of it
+class LocalConnection {
+public:
+  LocalConnection();
+  ~LocalConnection();
+
+  bool is_open() const;
+  void Close();
+
+  bool Send(const std::string& message);
+  bool Receive(std::string* message);
+  // Receive fails if nothing arrives for this long, 0 waits forever
+  bool SetReceiveTimeout(int seconds);
+
+private:
+  friend bool ConnectLocal(const std::string& path, LocalConnection* connection);
+  friend class LocalServer;
+  LocalConnection(const LocalConnection&);
+  void operator=(const LocalConnection&);
+
+  int fd_;
+};
+
+// returns false if nothing is listening on the path
+bool ConnectLocal(const std::string& path, LocalConnection* connection);
+
+class LocalServer {
+public:
+  LocalServer();
+  ~LocalServer();
+
+  // returns a empty string on success
+  std::string Listen(const std::string& path);
+  bool Accept(LocalConnection* connection);
+  void Close();
+
+private:
+  LocalServer(const LocalServer&);
+  void operator=(const LocalServer&);
+
+  int fd_;
+  std::string path_;
+};
+
+#endif  // CORE_LOCALSOCKET_H_
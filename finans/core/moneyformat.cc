@@ -0,0 +1,60 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/moneyformat.h"
+
+namespace {
+bool IsLetter(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c & 0x80) != 0;
+}
+
+// longest value is -92,233,720,368,547,758.08
+const int MAX_DIGITS = 32;
+}  // namespace
+
+MoneyFormat::MoneyFormat() : grouped_(true) {
+}
+
+MoneyFormat::MoneyFormat(const std::string& before, const std::string& after)
+  : before_(before), after_(after), grouped_(true) {
+  if (before_.empty() == false && IsLetter(before_.back())) before_ += ' ';
+  if (after_.empty() == false && IsLetter(after_.front())) after_.insert(after_.begin(), ' ');
+}
+
+void MoneyFormat::Append(int64_t cents, std::string* out) const {
+  // unsigned so the most negative value can be negated
+  auto value = cents < 0 ? 0 - static_cast<uint64_t>(cents) : static_cast<uint64_t>(cents);
+
+  // written backwards from the end of the buffer
+  char buffer[MAX_DIGITS];
+  char* begin = buffer + MAX_DIGITS;
+  *--begin = static_cast<char>('0' + value % 10);
+  value /= 10;
+  *--begin = static_cast<char>('0' + value % 10);
+  value /= 10;
+  *--begin = '.';
+  int digits = 0;
+  do {
+    if (grouped_ && digits != 0 && digits % 3 == 0) *--begin = ',';
+    *--begin = static_cast<char>('0' + value % 10);
+    value /= 10;
+    ++digits;
+  } while (value != 0);
+
+  if (cents < 0) out->push_back('-');
+  out->append(before_);
+  out->append(begin, buffer + MAX_DIGITS);
+  out->append(after_);
+}
+
+MoneyFormat MoneyFormat::Plain(const std::string& name) {
+  MoneyFormat format;
+  format.after_ = " " + name;
+  format.grouped_ = false;
+  return format;
+}
+
+std::string MoneyFormat::Format(int64_t cents) const {
+  std::string out;
+  Append(cents, &out);
+  return out;
+}
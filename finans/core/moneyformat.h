@@ -0,0 +1,35 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_MONEYFORMAT_H_
+#define CORE_MONEYFORMAT_H_
+
+#include <cstdint>
+#include <string>
+
+// the value_before and value_after of a currency, prepared once for printing
+// many values. cents are written as 1,234.56 with the sign in front of
+// everything, like -$20.00 or -20.00 kr. a space is put between the number
+// and a before or after that ends or starts with a letter, so SEK becomes
+// SEK 20.00 and kr becomes 20.00 kr while $ stays $20.00.
+// a currency without a before or after is printed plain as 1234.56 SEK, the
+// same as before currencies had a format.
+// the append function adds to the end of out, so a caller can reuse one
+// buffer for a whole listing
+class MoneyFormat {
+public:
+  // just the number
+  MoneyFormat();
+  MoneyFormat(const std::string& before, const std::string& after);
+  // ungrouped with the name after a space
+  static MoneyFormat Plain(const std::string& name);
+
+  void Append(int64_t cents, std::string* out) const;
+  std::string Format(int64_t cents) const;
+
+private:
+  std::string before_;
+  std::string after_;
+  bool grouped_;
+};
+
+#endif  // CORE_MONEYFORMAT_H_
@@ -0,0 +1,19 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/nameindex.h"
+
+#include "finans/core/stringutils.h"
+
+void NameIndex::Clear() {
+  index_.clear();
+}
+
+void NameIndex::Add(const std::string& name, int index) {
+  index_.insert(std::make_pair(ToLower(name), index));
+}
+
+int NameIndex::Find(const std::string& name) const {
+  const auto found = index_.find(ToLower(name));
+  if (found == index_.end()) return -1;
+  return found->second;
+}
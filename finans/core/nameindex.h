@@ -0,0 +1,24 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_NAMEINDEX_H_
+#define CORE_NAMEINDEX_H_
+
+#include <string>
+#include <unordered_map>
+
+// case insensitive lookup from a name to its index
+class NameIndex {
+public:
+  void Clear();
+
+  // if the name is already added the first index is kept
+  void Add(const std::string& name, int index);
+
+  // returns -1 if not found
+  int Find(const std::string& name) const;
+
+private:
+  std::unordered_map<std::string, int> index_;
+};
+
+#endif  // CORE_NAMEINDEX_H_
@@ -9,6 +9,13 @@
 #include <io.h>
 #endif
 
+#ifdef FINANS_UNIX
+#include <cerrno>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
 const char FOLDER_SEPERATOR =
 #if defined(FINANS_UNIX)
 '/';
@@ -36,6 +43,16 @@ std::string FindUserPath() {
       return path;
     }
   }
+#elif defined(FINANS_UNIX)
+  const char* home = getenv("HOME");
+  if (home == nullptr || home[0] == 0) return "";
+  const auto path = EndWithSlash(home) + ".finans/";
+  if (mkdir(path.c_str(), 0700) != 0 && errno != EEXIST) {
+    return "";
+  }
+  else {
+    return path;
+  }
 #else
 #error "IMPLEMENT ME"
 #endif
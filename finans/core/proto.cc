@@ -6,11 +6,26 @@
 
 #include <streambuf>
 #include <cassert>
+#include <algorithm>
 #include <fstream>  // NOLINT this is how we use fstrean
 #include <sstream>  // NOLINT this is how we use sstream
 
 #include "pbjson.hpp"  // NOLINT this is how we use tinyxml2
 
+#include "finans/core/file.h"
+
+namespace {
+// png style magic, a json file can never start with this and any newline
+// conversion done to the file will break the magic and not the data
+const char BINARY_MAGIC[] = { '\x89', 'F', 'I', 'N', '\r', '\n', '\x1a', '\n' };
+const std::size_t BINARY_MAGIC_SIZE = sizeof(BINARY_MAGIC);
+
+bool HasBinaryMagic(const char* data, std::size_t size) {
+  if (size < BINARY_MAGIC_SIZE) return false;
+  return std::equal(BINARY_MAGIC, BINARY_MAGIC + BINARY_MAGIC_SIZE, data);
+}
+}  // namespace
+
 
 std::string LoadProtoJson(google::protobuf::Message* message,
                        const std::string& path) {
@@ -25,10 +40,49 @@ std::string LoadProtoJson(google::protobuf::Message* message,
 
 std::string SaveProtoJson(const google::protobuf::Message& t,
                        const std::string& path) {
-  bool write_result = pbjson::pb2json_file(&t, path, true);
-  if (write_result == false) {
-    return "Unable to write to file";
+  std::string data;
+  pbjson::pb2json(&t, data, true);
+  return ReplaceFile(path, data);
+}
+
+bool IsProtoBinary(const std::string& path) {
+  std::ifstream f(path.c_str(), std::ios::in | std::ios::binary);
+  if (!f) return false;
+  char header[BINARY_MAGIC_SIZE];
+  f.read(header, BINARY_MAGIC_SIZE);
+  return HasBinaryMagic(header, static_cast<std::size_t>(f.gcount()));
+}
+
+std::string LoadProtoBinary(google::protobuf::Message* message,
+                            const std::string& path) {
+  std::ifstream f(path.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+  if (!f) return "Unable to open file";
+
+  // read everything in one go, parsing from a flat array is a lot faster
+  // than going through a stream
+  std::string data(static_cast<std::size_t>(f.tellg()), '\0');
+  f.seekg(0, std::ios::beg);
+  if (data.empty() == false) f.read(&data[0], data.size());
+  if (!f) return "Unable to read file";
+  if (HasBinaryMagic(data.data(), data.size()) == false) {
+    return "Not a binary finans file";
+  }
+
+  const auto payload_size = data.size() - BINARY_MAGIC_SIZE;
+  if (false == message->ParseFromArray(data.data() + BINARY_MAGIC_SIZE,
+                                       static_cast<int>(payload_size))) {
+    return "Corrupt binary file";
   }
 
   return "";
 }
+
+std::string SaveProtoBinary(const google::protobuf::Message& t,
+                            const std::string& path) {
+  std::string data(BINARY_MAGIC, BINARY_MAGIC_SIZE);
+  if (false == t.AppendToString(&data)) {
+    return "Unable to serialize";
+  }
+
+  return ReplaceFile(path, data);
+}
@@ -9,4 +9,9 @@
 std::string LoadProtoJson(google::protobuf::Message* t, const std::string& path);
 std::string SaveProtoJson(const google::protobuf::Message& t, const std::string& path);
 
+// binary files are the protobuf wire format prefixed with a magic header
+bool IsProtoBinary(const std::string& path);
+std::string LoadProtoBinary(google::protobuf::Message* t, const std::string& path);
+std::string SaveProtoBinary(const google::protobuf::Message& t, const std::string& path);
+
 #endif  // CORE_PROTO_H_
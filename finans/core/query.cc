@@ -0,0 +1,275 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/query.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <functional>
+
+#include "finans/core/dateparser.h"
+#include "finans/core/datetime.h"
+#include "finans/core/stringutils.h"
+
+namespace {
+const std::size_t BATCH_SIZE = 1024;
+
+bool IsOperatorChar(char c) {
+  return c == '=' || c == '!' || c == '<' || c == '>';
+}
+
+// splits into words, operators and quoted strings
+std::string Tokenize(const std::string& text, std::vector<std::string>* tokens) {
+  std::size_t i = 0;
+  while (i < text.size()) {
+    const char c = text[i];
+    if (isspace(static_cast<unsigned char>(c))) {
+      ++i;
+    }
+    else if (c == '"') {
+      const auto end = text.find('"', i + 1);
+      if (end == std::string::npos) return "Missing end quote";
+      // a leading quote marks it as a string so it is never read as a keyword
+      tokens->push_back(text.substr(i, end - i));
+      i = end + 1;
+    }
+    else if (IsOperatorChar(c)) {
+      const auto start = i;
+      while (i < text.size() && IsOperatorChar(text[i])) ++i;
+      tokens->push_back(text.substr(start, i - start));
+    }
+    else {
+      const auto start = i;
+      while (i < text.size() && !isspace(static_cast<unsigned char>(text[i])) && !IsOperatorChar(text[i]) && text[i] != '"') ++i;
+      tokens->push_back(text.substr(start, i - start));
+    }
+  }
+  return "";
+}
+
+bool ParseField(const std::string& name, QueryField* field) {
+  const auto n = ToLower(name);
+  if (n == "account") *field = QueryField::ACCOUNT;
+  else if (n == "company") *field = QueryField::COMPANY;
+  else if (n == "currency") *field = QueryField::CURRENCY;
+  else if (n == "category") *field = QueryField::CATEGORY;
+  else if (n == "value") *field = QueryField::VALUE;
+  else if (n == "when") *field = QueryField::WHEN;
+  else return false;
+  return true;
+}
+
+bool ParseOp(const std::string& op, QueryOp* ret) {
+  if (op == "=" || op == "==") *ret = QueryOp::EQUAL;
+  else if (op == "!=") *ret = QueryOp::NOT_EQUAL;
+  else if (op == "<") *ret = QueryOp::LESS;
+  else if (op == "<=") *ret = QueryOp::LESS_EQUAL;
+  else if (op == ">") *ret = QueryOp::GREATER;
+  else if (op == ">=") *ret = QueryOp::GREATER_EQUAL;
+  else return false;
+  return true;
+}
+
+bool ParseInteger(const std::string& text, int64_t* value) {
+  long long v = 0;
+  char extra = 0;
+  if (sscanf(text.c_str(), "%lld%c", &v, &extra) != 1) return false;
+  *value = v;
+  return true;
+}
+
+// YYYY-MM-DD as the local midnights that start the day and the next
+bool ParseDay(const std::string& text, UtcOffsetTable* local_time, int64_t* begin, int64_t* end) {
+  ParsedDate date;
+  if (false == ParseDate(text.data(), text.data() + text.size(), DateOrder::YEAR_MONTH_DAY, &date) || date.seconds != 0) {
+    return false;
+  }
+  const auto day = DaysFromCivil(date.year, date.month, date.day);
+  *begin = local_time->Midnight(day);
+  *end = local_time->Midnight(day + 1);
+  return true;
+}
+
+std::string Unquote(const std::string& token) {
+  return token.empty() == false && token[0] == '"' ? token.substr(1) : token;
+}
+
+std::string ResolveName(QueryField field, const std::string& token, const QueryNames& names, int64_t* operand) {
+  const auto name = Unquote(token);
+  int index = -1;
+  switch (field) {
+  case QueryField::ACCOUNT:
+    index = names.GetAccountByName(name);
+    break;
+  case QueryField::COMPANY:
+    index = names.GetCompanyByName(name);
+    break;
+  case QueryField::CURRENCY:
+    index = names.GetCurrencyByName(name);
+    break;
+  case QueryField::CATEGORY:
+    if (token == "-") {
+      *operand = -1;
+      return "";
+    }
+    index = names.GetCategoryByName(name);
+    break;
+  default:
+    break;
+  }
+  if (index == -1) return "Unknown name " + name;
+  *operand = index;
+  return "";
+}
+
+// keeps the selected rows where the column passes, the comparison is a
+// template argument so the inner loop is a plain compare
+template<typename T, typename Compare>
+void Keep(const T* column, int64_t operand, Compare compare, std::vector<int>* selected) {
+  std::size_t kept = 0;
+  for (const auto row : *selected) {
+    (*selected)[kept] = row;
+    kept += compare(static_cast<int64_t>(column[row]), operand) ? 1 : 0;
+  }
+  selected->resize(kept);
+}
+
+template<typename T>
+void Filter(const T* column, QueryOp op, int64_t operand, std::vector<int>* selected) {
+  switch (op) {
+  case QueryOp::EQUAL:
+    Keep(column, operand, std::equal_to<int64_t>(), selected);
+    break;
+  case QueryOp::NOT_EQUAL:
+    Keep(column, operand, std::not_equal_to<int64_t>(), selected);
+    break;
+  case QueryOp::LESS:
+    Keep(column, operand, std::less<int64_t>(), selected);
+    break;
+  case QueryOp::LESS_EQUAL:
+    Keep(column, operand, std::less_equal<int64_t>(), selected);
+    break;
+  case QueryOp::GREATER:
+    Keep(column, operand, std::greater<int64_t>(), selected);
+    break;
+  case QueryOp::GREATER_EQUAL:
+    Keep(column, operand, std::greater_equal<int64_t>(), selected);
+    break;
+  }
+}
+
+// like Filter but the operand is the range [begin, end) and compares as one value
+template<typename T>
+void FilterRange(const T* column, QueryOp op, int64_t begin, int64_t end, std::vector<int>* selected) {
+  switch (op) {
+  case QueryOp::EQUAL:
+    Keep(column, begin, std::greater_equal<int64_t>(), selected);
+    Keep(column, end, std::less<int64_t>(), selected);
+    break;
+  case QueryOp::NOT_EQUAL:
+    Keep(column, begin, [end](int64_t value, int64_t b) { return value < b || value >= end; }, selected);
+    break;
+  case QueryOp::LESS:
+    Keep(column, begin, std::less<int64_t>(), selected);
+    break;
+  case QueryOp::LESS_EQUAL:
+    Keep(column, end, std::less<int64_t>(), selected);
+    break;
+  case QueryOp::GREATER:
+    Keep(column, end, std::greater_equal<int64_t>(), selected);
+    break;
+  case QueryOp::GREATER_EQUAL:
+    Keep(column, begin, std::greater_equal<int64_t>(), selected);
+    break;
+  }
+}
+}  // namespace
+
+QueryNames::~QueryNames() {
+}
+
+std::string Query::Compile(const std::string& text, const QueryNames& names) {
+  conditions_.clear();
+  std::vector<std::string> tokens;
+  const auto error = Tokenize(text, &tokens);
+  if (error.empty() == false) return error;
+
+  UtcOffsetTable local_time;
+  std::size_t i = 0;
+  while (i < tokens.size()) {
+    if (conditions_.empty() == false) {
+      if (ToLower(tokens[i]) != "and") return "Expected and, got " + tokens[i];
+      ++i;
+    }
+    if (i + 3 > tokens.size()) return "Expected field, operator and value";
+
+    QueryCondition c;
+    c.operand_end = 0;
+    if (false == ParseField(tokens[i], &c.field)) return "Unknown field " + tokens[i];
+    if (false == ParseOp(tokens[i + 1], &c.op)) return "Unknown operator " + tokens[i + 1];
+    const auto& value = tokens[i + 2];
+    i += 3;
+
+    switch (c.field) {
+    case QueryField::VALUE:
+      if (false == ParseInteger(value, &c.operand)) return "Invalid value " + value + ", expected cents";
+      break;
+    case QueryField::WHEN:
+      if (false == ParseDay(value, &local_time, &c.operand, &c.operand_end)) return "Invalid date " + value + ", expected YYYY-MM-DD";
+      break;
+    default: {
+      if (c.op != QueryOp::EQUAL && c.op != QueryOp::NOT_EQUAL) return "Names can only be compared with = and !=";
+      const auto name_error = ResolveName(c.field, value, names, &c.operand);
+      if (name_error.empty() == false) return name_error;
+      break;
+    }
+    }
+    conditions_.push_back(c);
+  }
+
+  return "";
+}
+
+std::vector<int> Query::Run(const ExchangeColumns& columns) const {
+  std::vector<int> ret;
+  std::vector<int> selected;
+  selected.reserve(BATCH_SIZE);
+  for (std::size_t begin = 0; begin < columns.size(); begin += BATCH_SIZE) {
+    const auto end = std::min(columns.size(), begin + BATCH_SIZE);
+    selected.clear();
+    for (auto row = begin; row < end; ++row) {
+      selected.push_back(static_cast<int>(row));
+    }
+
+    for (const auto& c : conditions_) {
+      if (selected.empty()) break;
+      switch (c.field) {
+      case QueryField::ACCOUNT:
+        Filter(columns.accounts().data(), c.op, c.operand, &selected);
+        break;
+      case QueryField::COMPANY:
+        Filter(columns.companies().data(), c.op, c.operand, &selected);
+        break;
+      case QueryField::CURRENCY:
+        Filter(columns.currencies().data(), c.op, c.operand, &selected);
+        break;
+      case QueryField::CATEGORY:
+        Filter(columns.categories().data(), c.op, c.operand, &selected);
+        break;
+      case QueryField::VALUE:
+        Filter(columns.values().data(), c.op, c.operand, &selected);
+        break;
+      case QueryField::WHEN:
+        FilterRange(columns.whens().data(), c.op, c.operand, c.operand_end, &selected);
+        break;
+      }
+    }
+
+    ret.insert(ret.end(), selected.begin(), selected.end());
+  }
+  return ret;
+}
+
+const std::vector<QueryCondition>& Query::conditions() const {
+  return conditions_;
+}
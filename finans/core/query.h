@@ -0,0 +1,67 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_QUERY_H_
+#define CORE_QUERY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "finans/core/exchangecolumns.h"
+
+/*
+A filter over the external exchanges, for example:
+  category=Food and when>=2015-01-01 and value<-10000
+
+A query is a number of conditions joined by and. The fields are account,
+company, currency, category (- is uncategorized), value (in cents) and when
+(YYYY-MM-DD, local time). A date is the whole day, so when=2015-03-01 is
+any time that day and when>2015-03-01 starts the day after. Names only
+support = and !=, names with spaces can be written in double quotes.
+
+Names and dates are resolved when the query is compiled, running it only
+compares numbers.
+*/
+
+enum class QueryField {
+  ACCOUNT, COMPANY, CURRENCY, CATEGORY, VALUE, WHEN
+};
+
+enum class QueryOp {
+  EQUAL, NOT_EQUAL, LESS, LESS_EQUAL, GREATER, GREATER_EQUAL
+};
+
+struct QueryCondition {
+  QueryField field;
+  QueryOp op;
+  int64_t operand;
+  // for when the operand is the start of the day and this is the next midnight
+  int64_t operand_end;
+};
+
+// resolves names while compiling, returns -1 for unknown names
+class QueryNames {
+public:
+  virtual ~QueryNames();
+  virtual int GetAccountByName(const std::string& name) const = 0;
+  virtual int GetCompanyByName(const std::string& name) const = 0;
+  virtual int GetCurrencyByName(const std::string& name) const = 0;
+  virtual int GetCategoryByName(const std::string& name) const = 0;
+};
+
+class Query {
+public:
+  // returns a error or a empty string
+  std::string Compile(const std::string& text, const QueryNames& names);
+
+  // the indices of the matching exchanges, in column order.
+  // the rows are filtered a batch at a time, one condition at a time
+  std::vector<int> Run(const ExchangeColumns& columns) const;
+
+  const std::vector<QueryCondition>& conditions() const;
+
+private:
+  std::vector<QueryCondition> conditions_;
+};
+
+#endif  // CORE_QUERY_H_
@@ -0,0 +1,154 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/rates.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace {
+int64_t Round(double value) {
+  return static_cast<int64_t>(std::floor(value + 0.5));
+}
+}  // namespace
+
+ConversionMatrix::ConversionMatrix(int currencies)
+  : size_(currencies)
+  , rates_(static_cast<std::size_t>(currencies * currencies), std::numeric_limits<double>::quiet_NaN()) {
+  for (int i = 0; i < size_; ++i) {
+    Set(i, i, 1.0);
+  }
+}
+
+int ConversionMatrix::size() const {
+  return size_;
+}
+
+bool ConversionMatrix::Has(int from, int to) const {
+  if (from < 0 || from >= size_ || to < 0 || to >= size_) return false;
+  return std::isnan(rates_[from * size_ + to]) == false;
+}
+
+double ConversionMatrix::Get(int from, int to) const {
+  assert(Has(from, to));
+  return rates_[from * size_ + to];
+}
+
+void ConversionMatrix::Set(int from, int to, double rate) {
+  assert(from >= 0 && from < size_ && to >= 0 && to < size_);
+  rates_[from * size_ + to] = rate;
+}
+
+void ConversionMatrix::Complete() {
+  // floyd-warshall, but only missing rates are filled in so a direct rate
+  // always wins over a rate through another currency
+  for (int via = 0; via < size_; ++via) {
+    for (int from = 0; from < size_; ++from) {
+      if (Has(from, via) == false) continue;
+      for (int to = 0; to < size_; ++to) {
+        if (Has(from, to) || Has(via, to) == false) continue;
+        Set(from, to, Get(from, via) * Get(via, to));
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void RateTable::Clear() {
+  rates_.clear();
+  matrices_.clear();
+}
+
+void RateTable::Add(int from, int to, int64_t when, double rate) {
+  assert(rate > 0);
+  const auto insert = [when](std::vector<Rate>* rates, double r) {
+    Rate added;
+    added.when = when;
+    added.rate = r;
+    // after the rates with the same time, so the last added wins
+    const auto position = std::upper_bound(rates->begin(), rates->end(), when, [](int64_t lhs, const Rate& rhs) {
+      return lhs < rhs.when;
+    });
+    rates->insert(position, added);
+  };
+  insert(&rates_[std::make_pair(from, to)], rate);
+  insert(&rates_[std::make_pair(to, from)], 1.0 / rate);
+  matrices_.clear();
+}
+
+bool RateTable::GetRate(int from, int to, int64_t when, double* rate) const {
+  if (from == to) {
+    *rate = 1.0;
+    return true;
+  }
+  const auto found = rates_.find(std::make_pair(from, to));
+  if (found == rates_.end() || found->second.empty()) return false;
+  const auto& rates = found->second;
+  const auto after = std::upper_bound(rates.begin(), rates.end(), when, [](int64_t lhs, const Rate& rhs) {
+    return lhs < rhs.when;
+  });
+  // a later rate isn't used for the past
+  if (after == rates.begin()) return false;
+  *rate = (after - 1)->rate;
+  return true;
+}
+
+const ConversionMatrix& RateTable::GetMatrix(int currencies, int64_t when) const {
+  const auto day = local_time_.LocalDay(when);
+  const auto key = std::make_pair(currencies, day);
+  const auto cached = matrices_.find(key);
+  if (cached != matrices_.end()) return cached->second;
+
+  const auto end_of_day = local_time_.Midnight(day + 1) - 1;
+  ConversionMatrix matrix(currencies);
+  for (const auto& r : rates_) {
+    const auto from = r.first.first;
+    const auto to = r.first.second;
+    if (from >= currencies || to >= currencies) continue;
+    double rate = 0;
+    if (GetRate(from, to, end_of_day, &rate)) matrix.Set(from, to, rate);
+  }
+  matrix.Complete();
+  return matrices_.insert(std::make_pair(key, matrix)).first->second;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool ConvertValues(const ConversionMatrix& matrix, int target,
+                   const int* currencies, const int* values, std::size_t count, int64_t* converted) {
+  // one factor per currency so the loop doesn't touch the matrix
+  std::vector<double> factors(matrix.size(), 0.0);
+  std::vector<bool> known(matrix.size(), false);
+  for (int c = 0; c < matrix.size(); ++c) {
+    known[c] = matrix.Has(c, target);
+    if (known[c]) factors[c] = matrix.Get(c, target);
+  }
+
+  bool all = true;
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto c = currencies[i];
+    const bool ok = c >= 0 && c < matrix.size() && known[c];
+    converted[i] = ok ? Round(values[i] * factors[c]) : 0;
+    all = all && ok;
+  }
+  return all;
+}
+
+bool ConvertValuesAt(const RateTable& rates, int number_of_currencies, int target,
+                     const int* currencies, const int* values, const int64_t* whens, std::size_t count, int64_t* converted) {
+  UtcOffsetTable local_time;
+  bool all = true;
+  std::size_t begin = 0;
+  while (begin < count) {
+    // the values are usually close in time, convert runs of the same day with the same matrix
+    const auto day = local_time.LocalDay(whens[begin]);
+    auto end = begin + 1;
+    while (end < count && local_time.LocalDay(whens[end]) == day) ++end;
+    const auto& matrix = rates.GetMatrix(number_of_currencies, whens[begin]);
+    all = ConvertValues(matrix, target, currencies + begin, values + begin, end - begin, converted + begin) && all;
+    begin = end;
+  }
+  return all;
+}
@@ -0,0 +1,69 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_RATES_H_
+#define CORE_RATES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "finans/core/datetime.h"
+
+// the rates between all currencies at one point in time, rate(from, to) is
+// how many to you get for one from. currencies without a rate, direct or
+// through other currencies, are missing
+class ConversionMatrix {
+public:
+  explicit ConversionMatrix(int currencies);
+
+  int size() const;
+  bool Has(int from, int to) const;
+  double Get(int from, int to) const;
+  void Set(int from, int to, double rate);
+
+  // fills in the missing rates by going through other currencies
+  void Complete();
+
+private:
+  int size_;
+  // nan for missing
+  std::vector<double> rates_;
+};
+
+// time stamped rates between currencies, every rate is usable in both directions
+class RateTable {
+public:
+  void Clear();
+  void Add(int from, int to, int64_t when, double rate);
+
+  // the latest rate at or before when, false if there is none yet
+  bool GetRate(int from, int to, int64_t when, double* rate) const;
+
+  // the rates at the end of the local day when is in, like the balances.
+  // the matrices are cached per day until a rate is added, so this isn't
+  // thread safe
+  const ConversionMatrix& GetMatrix(int currencies, int64_t when) const;
+
+private:
+  struct Rate {
+    int64_t when;
+    double rate;
+  };
+  // sorted by when
+  std::map<std::pair<int, int>, std::vector<Rate>> rates_;
+  mutable std::map<std::pair<int, int64_t>, ConversionMatrix> matrices_;
+  mutable UtcOffsetTable local_time_;
+};
+
+// converts the values to the target currency at the matrix, values in a
+// currency without a rate are set to 0 and false is returned
+bool ConvertValues(const ConversionMatrix& matrix, int target,
+                   const int* currencies, const int* values, std::size_t count, int64_t* converted);
+
+// like ConvertValues but each value is converted at the rates of the local day of its when
+bool ConvertValuesAt(const RateTable& rates, int number_of_currencies, int target,
+                     const int* currencies, const int* values, const int64_t* whens, std::size_t count, int64_t* converted);
+
+#endif  // CORE_RATES_H_
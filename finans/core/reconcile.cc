@@ -0,0 +1,84 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/reconcile.h"
+
+#include <unordered_map>
+
+#include "finans/core/datetime.h"
+
+namespace {
+struct Key {
+  int account;
+  int company;
+  int value;
+  int64_t day;
+
+  bool operator==(const Key& rhs) const {
+    return account == rhs.account && company == rhs.company && value == rhs.value && day == rhs.day;
+  }
+};
+
+struct KeyHash {
+  std::size_t operator()(const Key& k) const {
+    uint64_t h = static_cast<uint32_t>(k.account);
+    h = h * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(k.company);
+    h = h * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(k.value);
+    h = h * 0x9E3779B97F4A7C15ull + static_cast<uint64_t>(k.day);
+    return static_cast<std::size_t>(h ^ (h >> 29));
+  }
+};
+
+struct Group {
+  Group() : imported(0) { }
+
+  int imported;
+  std::vector<int> existing;
+};
+}  // namespace
+
+ReconcileReport::ReconcileReport() : added(0), matched(0), ambiguous(0) {
+}
+
+void Reconcile(const ExchangeColumns& columns, const std::vector<int>& existing, ReconcileReport* report) {
+  UtcOffsetTable local_time;
+  std::unordered_map<Key, Group, KeyHash> groups;
+  groups.reserve(report->rows.size());
+
+  // build on the import, it is usually the smaller side
+  std::vector<Group*> row_groups;
+  row_groups.reserve(report->rows.size());
+  for (const auto& row : report->rows) {
+    const Key key = { row.account, row.company, row.value, local_time.LocalDay(row.when) };
+    auto* group = &groups[key];
+    group->imported += 1;
+    row_groups.push_back(group);
+  }
+
+  // probe with the ledger
+  for (const auto index : existing) {
+    const Key key = { columns.accounts()[index], columns.companies()[index], columns.values()[index], local_time.LocalDay(columns.whens()[index]) };
+    const auto found = groups.find(key);
+    if (found != groups.end()) found->second.existing.push_back(index);
+  }
+
+  report->added = 0;
+  report->matched = 0;
+  report->ambiguous = 0;
+  for (std::size_t i = 0; i < report->rows.size(); ++i) {
+    auto& row = report->rows[i];
+    const auto* group = row_groups[i];
+    row.matches = group->existing;
+    if (group->existing.empty()) {
+      row.status = ReconcileStatus::NEW;
+      report->added += 1;
+    }
+    else if (group->existing.size() == static_cast<std::size_t>(group->imported)) {
+      row.status = ReconcileStatus::MATCHED;
+      report->matched += 1;
+    }
+    else {
+      row.status = ReconcileStatus::AMBIGUOUS;
+      report->ambiguous += 1;
+    }
+  }
+}
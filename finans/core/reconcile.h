@@ -0,0 +1,46 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_RECONCILE_H_
+#define CORE_RECONCILE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "finans/core/exchangecolumns.h"
+
+enum class ReconcileStatus {
+  // nothing in the ledger looks like it
+  NEW,
+  // as many exchanges in the ledger as in the import look like it
+  MATCHED,
+  // some, but not the same number, of exchanges in the ledger look like it
+  AMBIGUOUS
+};
+
+// a imported exchange, two exchanges are the same if they have the same
+// account, company, value and local day
+struct ReconcileRow {
+  int account;
+  int company;
+  int value;
+  int64_t when;
+
+  ReconcileStatus status;
+  // the exchanges in the ledger that look like this one
+  std::vector<int> matches;
+};
+
+struct ReconcileReport {
+  ReconcileReport();
+
+  std::vector<ReconcileRow> rows;
+  int added;
+  int matched;
+  int ambiguous;
+};
+
+// hash join of the rows against the exchanges in columns with the indices in
+// existing, sets status and matches of every row and counts them
+void Reconcile(const ExchangeColumns& columns, const std::vector<int>& existing, ReconcileReport* report);
+
+#endif  // CORE_RECONCILE_H_
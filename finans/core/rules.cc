@@ -0,0 +1,162 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/rules.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "finans/core/finans-proto.h"
+#include "finans/core/proto.h"
+
+namespace {
+uint8_t Fold(char c) {
+  return static_cast<uint8_t>(std::tolower(static_cast<unsigned char>(c)));
+}
+}  // namespace
+
+PatternMatcher::PatternMatcher() {
+  Clear();
+}
+
+void PatternMatcher::Clear() {
+  std::fill(classes_, classes_ + 256, 0);
+  class_count_ = 1;
+  next_.clear();
+  found_.clear();
+  patterns_.clear();
+}
+
+void PatternMatcher::Add(const std::string& pattern, int id) {
+  patterns_.push_back(std::make_pair(pattern, id));
+}
+
+int PatternMatcher::Class(char c) const {
+  return classes_[static_cast<unsigned char>(c)];
+}
+
+void PatternMatcher::Compile() {
+  // only the characters in the patterns need their own class, this keeps
+  // the transition table small even for thousands of patterns
+  std::fill(classes_, classes_ + 256, 0);
+  class_count_ = 1;
+  for (const auto& p : patterns_) {
+    for (const char c : p.first) {
+      const auto folded = Fold(c);
+      if (classes_[folded] != 0) continue;
+      const auto cls = static_cast<uint16_t>(class_count_++);
+      classes_[folded] = cls;
+      classes_[static_cast<uint8_t>(std::toupper(folded))] = cls;
+    }
+  }
+
+  // the trie, -1 is a missing transition
+  next_.assign(class_count_, -1);
+  found_.assign(1, -1);
+  for (const auto& p : patterns_) {
+    int state = 0;
+    for (const char c : p.first) {
+      auto& next = next_[state * class_count_ + Class(c)];
+      if (next == -1) {
+        next = static_cast<int>(found_.size());
+        found_.push_back(-1);
+        next_.resize(next_.size() + class_count_, -1);
+      }
+      state = next_[state * class_count_ + Class(c)];
+    }
+    if (found_[state] == -1 || p.second < found_[state]) found_[state] = p.second;
+  }
+
+  // breadth first, turn the trie into a automaton where every state has a
+  // transition for every class and found includes the suffixes
+  std::vector<int> fail(found_.size(), 0);
+  std::vector<int> queue;
+  queue.reserve(found_.size());
+  for (int cls = 0; cls < class_count_; ++cls) {
+    auto& next = next_[cls];
+    if (next == -1) {
+      next = 0;
+    }
+    else {
+      fail[next] = 0;
+      queue.push_back(next);
+    }
+  }
+  for (std::size_t i = 0; i < queue.size(); ++i) {
+    const int state = queue[i];
+    const int suffix = found_[fail[state]];
+    if (suffix != -1 && (found_[state] == -1 || suffix < found_[state])) found_[state] = suffix;
+    for (int cls = 0; cls < class_count_; ++cls) {
+      auto& next = next_[state * class_count_ + cls];
+      const int fallback = next_[fail[state] * class_count_ + cls];
+      if (next == -1) {
+        next = fallback;
+      }
+      else {
+        fail[next] = fallback;
+        queue.push_back(next);
+      }
+    }
+  }
+}
+
+int PatternMatcher::Find(const char* begin, const char* end) const {
+  if (next_.empty()) return -1;
+  int state = 0;
+  int found = -1;
+  for (const char* c = begin; c != end; ++c) {
+    state = next_[state * class_count_ + Class(*c)];
+    const int id = found_[state];
+    if (id != -1 && (found == -1 || id < found)) found = id;
+  }
+  return found;
+}
+
+int PatternMatcher::Find(const std::string& text) const {
+  return Find(text.data(), text.data() + text.size());
+}
+
+std::size_t PatternMatcher::states() const {
+  return found_.size();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+std::string Rules::Load(const std::string& path) {
+  finans::Rules loaded;
+  const auto error = LoadProtoJson(&loaded, path);
+  if (error.empty() == false) return error;
+  for (const auto& r : loaded.rules()) {
+    if (r.pattern().empty()) return "Rule without a pattern";
+    Add(r.pattern(), r.category(), r.company());
+  }
+  return "";
+}
+
+void Rules::Add(const std::string& pattern, const std::string& category, const std::string& company) {
+  Rule r;
+  r.pattern = pattern;
+  r.category = category;
+  r.company = company;
+  r.hits = 0;
+  rules_.push_back(r);
+}
+
+void Rules::Compile() {
+  matcher_.Clear();
+  for (std::size_t i = 0; i < rules_.size(); ++i) {
+    matcher_.Add(rules_[i].pattern, static_cast<int>(i));
+  }
+  matcher_.Compile();
+}
+
+int Rules::Find(const std::string& payee) const {
+  return matcher_.Find(payee);
+}
+
+void Rules::AddHit(int rule) {
+  rules_[rule].hits += 1;
+}
+
+const std::vector<Rule>& Rules::rules() const {
+  return rules_;
+}
@@ -0,0 +1,70 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_RULES_H_
+#define CORE_RULES_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// finds which of many patterns are in a text in a single pass over the text,
+// a aho-corasick automaton. ascii letters are matched ignoring case
+class PatternMatcher {
+public:
+  PatternMatcher();
+
+  void Clear();
+  // the id is returned by Find, the patterns must be added before Compile
+  void Add(const std::string& pattern, int id);
+  void Compile();
+
+  // the lowest id of the patterns found in the text, -1 if none is found
+  int Find(const char* begin, const char* end) const;
+  int Find(const std::string& text) const;
+
+  std::size_t states() const;
+
+private:
+  int Class(char c) const;
+
+  // the character class of every byte, letters and their uppercase share a
+  // class and bytes not in any pattern share class 0. every byte can have
+  // its own class, so 256 classes plus class 0 needs more than a byte
+  uint16_t classes_[256];
+  int class_count_;
+  // transitions of all states, state * class_count_ + class
+  std::vector<int> next_;
+  // the lowest id that ends in the state or any of its suffixes
+  std::vector<int> found_;
+
+  std::vector<std::pair<std::string, int>> patterns_;
+};
+
+struct Rule {
+  std::string pattern;
+  std::string category;
+  std::string company;
+  // the number of exchanges the rule has decided
+  int hits;
+};
+
+class Rules {
+public:
+  // a json finans.Rules file
+  std::string Load(const std::string& path);
+
+  void Add(const std::string& pattern, const std::string& category, const std::string& company);
+  void Compile();
+
+  // the first rule with a pattern in the payee, -1 if none matches
+  int Find(const std::string& payee) const;
+  void AddHit(int rule);
+
+  const std::vector<Rule>& rules() const;
+
+private:
+  std::vector<Rule> rules_;
+  PatternMatcher matcher_;
+};
+
+#endif  // CORE_RULES_H_
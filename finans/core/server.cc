@@ -0,0 +1,114 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/server.h"
+
+#include <sstream>  // NOLINT this is how we use sstream
+
+#ifdef FINANS_UNIX
+#include <unistd.h>
+#endif
+
+#include "finans/core/finans-proto.h"
+#include "finans/core/localsocket.h"
+#include "finans/core/os.h"
+
+namespace {
+// seconds to wait for each part of a request
+const int RECEIVE_TIMEOUT = 10;
+
+std::string CurrentDirectory() {
+#ifdef FINANS_UNIX
+  char buffer[4096];
+  if (getcwd(buffer, sizeof(buffer)) != nullptr) return buffer;
+#endif
+  return "";
+}
+
+void ChangeDirectory(const std::string& dir) {
+#ifdef FINANS_UNIX
+  if (dir.empty() == false && chdir(dir.c_str()) != 0) {
+    // stay where we are, relative paths will fail in the command
+  }
+#endif
+}
+}  // namespace
+
+std::string ServerSocketPath() {
+  const auto user = FindUserPath();
+  if (user.empty()) return "";
+  return user + "fin.sock";
+}
+
+CommandServer::CommandServer(Runner runner) : runner_(runner), running_(false) {
+}
+
+std::string CommandServer::Serve(const std::string& socket) {
+  LocalServer server;
+  const auto error = server.Listen(socket);
+  if (error.empty() == false) return error;
+
+  running_ = true;
+  while (running_) {
+    LocalConnection connection;
+    if (false == server.Accept(&connection)) return "Failed to accept connection";
+    // a client that connects and sends nothing would block everyone else
+    connection.SetReceiveTimeout(RECEIVE_TIMEOUT);
+
+    std::string data;
+    finans::CommandRequest request;
+    if (false == connection.Receive(&data) || false == request.ParseFromString(data)) continue;
+
+    // file arguments are relative to the client and not to us
+    ChangeDirectory(request.working_directory());
+    const std::vector<std::string> arguments(request.arguments().begin(), request.arguments().end());
+    std::istringstream in(request.input());
+    std::ostringstream out;
+    std::ostringstream err;
+    const auto result = runner_(arguments, in, out, err);
+
+    finans::CommandResponse response;
+    response.set_result(result);
+    response.set_out(out.str());
+    response.set_err(err.str());
+    connection.Send(response.SerializeAsString());
+  }
+
+  return "";
+}
+
+void CommandServer::Stop() {
+  running_ = false;
+}
+
+bool ForwardCommand(const std::string& socket, const std::vector<std::string>& arguments, std::istream* input, std::ostream& out, std::ostream& err, int* result) {
+  if (socket.empty()) return false;
+  LocalConnection connection;
+  if (false == ConnectLocal(socket, &connection)) return false;
+
+  finans::CommandRequest request;
+  for (const auto& arg : arguments) {
+    request.add_arguments(arg);
+  }
+  request.set_working_directory(CurrentDirectory());
+  if (input != nullptr) {
+    std::ostringstream content;
+    content << input->rdbuf();
+    request.set_input(content.str());
+  }
+  if (false == connection.Send(request.SerializeAsString())) return false;
+
+  std::string data;
+  finans::CommandResponse response;
+  if (false == connection.Receive(&data) || false == response.ParseFromString(data)) {
+    // the server might have been in the middle of the command so it isn't
+    // safe to run it again here
+    err << "error: Lost connection to the server\n";
+    *result = -15;
+    return true;
+  }
+
+  out << response.out();
+  err << response.err();
+  *result = response.result();
+  return true;
+}
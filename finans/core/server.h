@@ -0,0 +1,35 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_SERVER_H_
+#define CORE_SERVER_H_
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// where fin serve listens, empty if there is no user path
+std::string ServerSocketPath();
+
+// runs command lines sent from other fin processes, one at a time
+class CommandServer {
+public:
+  typedef std::function<int (const std::vector<std::string>& arguments, std::istream& in, std::ostream& out, std::ostream& err)> Runner;
+
+  explicit CommandServer(Runner runner);
+
+  // blocks until Stop is called from a command, returns a empty string on success
+  std::string Serve(const std::string& socket);
+  void Stop();
+
+private:
+  Runner runner_;
+  bool running_;
+};
+
+// sends the command line to the running server and writes the output,
+// returns false if no server is running and the command should be run here.
+// input is sent along as the standard input of the command, if not null
+bool ForwardCommand(const std::string& socket, const std::vector<std::string>& arguments, std::istream* input, std::ostream& out, std::ostream& err, int* result);
+
+#endif  // CORE_SERVER_H_
@@ -116,3 +116,38 @@ std::vector<std::string> Tokenize(const std::string& input,
                                   bool remove_empties) {
   return Split(input, delimiters, remove_empties);
 }
+
+std::size_t StringRange::size() const {
+  return static_cast<std::size_t>(end - begin);
+}
+
+std::string StringRange::str() const {
+  return std::string(begin, end);
+}
+
+std::size_t Tokenize(const char* begin, const char* end,
+                     const std::string& delimiters, bool remove_empties,
+                     StringRange* tokens, std::size_t max_tokens) {
+  // same rules as the allocating version, a trailing delimiter doesn't add a empty token
+  std::size_t count = 0;
+  const char* start = begin;
+  for (const char* c = begin; c != end; ++c) {
+    if (delimiters.find(*c) == std::string::npos) continue;
+    if (c != start || remove_empties == false) {
+      if (count < max_tokens) {
+        tokens[count].begin = start;
+        tokens[count].end = c;
+      }
+      ++count;
+    }
+    start = c + 1;
+  }
+  if (start != end) {
+    if (count < max_tokens) {
+      tokens[count].begin = start;
+      tokens[count].end = end;
+    }
+    ++count;
+  }
+  return count;
+}
@@ -96,6 +96,29 @@ std::vector<std::string> Tokenize(const std::string& input,
                                   const std::string& delimiters,
                                   bool remove_empties);
 
+/** A part of a string that is owned by someone else.
+ */
+struct StringRange {
+  const char* begin;
+  const char* end;
+
+  std::size_t size() const;
+  std::string str() const;
+};
+
+/** Tokenize without allocating, for tight loops like parsing a file line by line.
+@param begin the start of the input.
+@param end one past the end of the input.
+@param delimiters the characters to split at.
+@param remove_empties if empty tokens should be ignored.
+@param tokens where to store the tokens.
+@param max_tokens the number of tokens that fit in tokens.
+@returns the number of tokens in the input, can be larger than max_tokens.
+ */
+std::size_t Tokenize(const char* begin, const char* end,
+                     const std::string& delimiters, bool remove_empties,
+                     StringRange* tokens, std::size_t max_tokens);
+
 /** @} */
 
 #endif  // RIDE_STRINGUTILS_H_
@@ -0,0 +1,79 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/summaries.h"
+
+MonthlySummaries::Month::Month() : valid(false) {
+}
+
+void MonthlySummaries::Clear() {
+  months_.clear();
+}
+
+void MonthlySummaries::SetMonth(int64_t month, const std::vector<SummaryRow>& rows) {
+  auto& m = months_[month];
+  m.valid = true;
+  m.rows = rows;
+}
+
+void MonthlySummaries::Invalidate(int64_t month) {
+  auto& m = months_[month];
+  m.valid = false;
+  m.rows.clear();
+}
+
+std::vector<int64_t> MonthlySummaries::GetInvalidMonths() const {
+  std::vector<int64_t> ret;
+  for (const auto& m : months_) {
+    if (m.second.valid == false) ret.push_back(m.first);
+  }
+  return ret;
+}
+
+bool MonthlySummaries::IsValid() const {
+  for (const auto& m : months_) {
+    if (m.second.valid == false) return false;
+  }
+  return true;
+}
+
+std::vector<int64_t> MonthlySummaries::GetMonths(int64_t from, int64_t to) const {
+  std::vector<int64_t> ret;
+  for (auto m = months_.lower_bound(from); m != months_.end() && m->first < to; ++m) {
+    if (m->second.valid) ret.push_back(m->first);
+  }
+  return ret;
+}
+
+const std::vector<SummaryRow>& MonthlySummaries::GetRows(int64_t month) const {
+  static const std::vector<SummaryRow> empty;
+  const auto found = months_.find(month);
+  if (found == months_.end()) return empty;
+  return found->second.rows;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void SummaryBuilder::Add(int account, int category, int currency, int64_t value) {
+  const auto key = std::make_tuple(account, category, currency);
+  auto found = rows_.find(key);
+  if (found == rows_.end()) {
+    SummaryRow row;
+    row.account = account;
+    row.category = category;
+    row.currency = currency;
+    row.sum = 0;
+    row.count = 0;
+    found = rows_.insert(std::make_pair(key, row)).first;
+  }
+  found->second.sum += value;
+  found->second.count += 1;
+}
+
+std::vector<SummaryRow> SummaryBuilder::GetRows() const {
+  std::vector<SummaryRow> ret;
+  ret.reserve(rows_.size());
+  for (const auto& r : rows_) {
+    ret.push_back(r.second);
+  }
+  return ret;
+}
@@ -0,0 +1,60 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_SUMMARIES_H_
+#define CORE_SUMMARIES_H_
+
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+// the external exchanges of one account, category and currency in a month
+struct SummaryRow {
+  int account;
+  int category;  // -1 for uncategorized
+  int currency;
+  int64_t sum;
+  int count;
+};
+
+// precomputed rows per month so reports over years doesn't need to look at
+// every exchange. a change to a month invalidates only that month, and it is
+// recomputed the next time the summaries are refreshed
+class MonthlySummaries {
+public:
+  void Clear();
+
+  // month is the start of the month, replaces and validates the month
+  void SetMonth(int64_t month, const std::vector<SummaryRow>& rows);
+  void Invalidate(int64_t month);
+
+  // the months that needs to be recomputed, sorted
+  std::vector<int64_t> GetInvalidMonths() const;
+  bool IsValid() const;
+
+  // the valid months where from <= month < to, sorted
+  std::vector<int64_t> GetMonths(int64_t from, int64_t to) const;
+  // rows are sorted by account, category and currency, empty for unknown months
+  const std::vector<SummaryRow>& GetRows(int64_t month) const;
+
+private:
+  struct Month {
+    Month();
+    bool valid;
+    std::vector<SummaryRow> rows;
+  };
+  std::map<int64_t, Month> months_;
+};
+
+// sums up the exchanges of a single month
+class SummaryBuilder {
+public:
+  void Add(int account, int category, int currency, int64_t value);
+  std::vector<SummaryRow> GetRows() const;
+
+private:
+  // account, category and currency
+  std::map<std::tuple<int, int, int>, SummaryRow> rows_;
+};
+
+#endif  // CORE_SUMMARIES_H_
@@ -0,0 +1,66 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/threadpool.h"
+
+ThreadPool::ThreadPool(int threads) : running_(0), stop_(false) {
+  const auto count = threads < 1 ? NumberOfCores() : threads;
+  for (int i = 0; i < count; ++i) {
+    threads_.push_back(std::thread(&ThreadPool::Work, this));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  task_added_.notify_all();
+  for (auto& t : threads_) {
+    t.join();
+  }
+}
+
+void ThreadPool::Add(const Task& task) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    tasks_.push_back(task);
+  }
+  task_added_.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  task_done_.wait(lock, [this]() { return tasks_.empty() && running_ == 0; });
+}
+
+int ThreadPool::size() const {
+  return static_cast<int>(threads_.size());
+}
+
+int ThreadPool::NumberOfCores() {
+  // may be 0 if it can't be detected
+  const auto cores = static_cast<int>(std::thread::hardware_concurrency());
+  return cores < 1 ? 1 : cores;
+}
+
+void ThreadPool::Work() {
+  for (;;) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_added_.wait(lock, [this]() { return stop_ || tasks_.empty() == false; });
+      if (tasks_.empty()) return;  // stopped and nothing left to do
+      task = tasks_.front();
+      tasks_.pop_front();
+      ++running_;
+    }
+
+    task();
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      --running_;
+    }
+    task_done_.notify_all();
+  }
+}
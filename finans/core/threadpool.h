@@ -0,0 +1,44 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_THREADPOOL_H_
+#define CORE_THREADPOOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// a fixed number of worker threads that run tasks in the order they were added
+class ThreadPool {
+public:
+  typedef std::function<void()> Task;
+
+  // threads below 1 uses one thread per core
+  explicit ThreadPool(int threads);
+  ~ThreadPool();
+
+  // tasks must not throw
+  void Add(const Task& task);
+
+  // blocks until every added task has finished
+  void Wait();
+
+  int size() const;
+
+  static int NumberOfCores();
+
+private:
+  void Work();
+
+  std::vector<std::thread> threads_;
+  std::deque<Task> tasks_;
+  std::mutex mutex_;
+  std::condition_variable task_added_;
+  std::condition_variable task_done_;
+  int running_;
+  bool stop_;
+};
+
+#endif  // CORE_THREADPOOL_H_
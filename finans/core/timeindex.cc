@@ -0,0 +1,105 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/timeindex.h"
+
+#include <algorithm>
+
+TimeIndex::Slice::Slice(const_iterator begin, const_iterator end) : begin_(begin), end_(end) {
+}
+
+TimeIndex::Slice::const_iterator TimeIndex::Slice::begin() const {
+  return begin_;
+}
+
+TimeIndex::Slice::const_iterator TimeIndex::Slice::end() const {
+  return end_;
+}
+
+std::size_t TimeIndex::Slice::size() const {
+  return static_cast<std::size_t>(end_ - begin_);
+}
+
+bool TimeIndex::Slice::empty() const {
+  return begin_ == end_;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void TimeIndex::Clear() {
+  whens_.clear();
+  indices_.clear();
+}
+
+void TimeIndex::Build(const std::vector<int64_t>& whens) {
+  indices_.resize(whens.size());
+  for (std::size_t i = 0; i < whens.size(); ++i) {
+    indices_[i] = static_cast<int>(i);
+  }
+  std::stable_sort(indices_.begin(), indices_.end(), [&whens](int lhs, int rhs) {
+    return whens[lhs] < whens[rhs];
+  });
+
+  whens_.resize(whens.size());
+  for (std::size_t i = 0; i < indices_.size(); ++i) {
+    whens_[i] = whens[indices_[i]];
+  }
+}
+
+void TimeIndex::Add(int64_t when, int index) {
+  if (whens_.empty() || whens_.back() <= when) {
+    whens_.push_back(when);
+    indices_.push_back(index);
+    return;
+  }
+
+  // after all the exchanges with the same time
+  const auto position = std::upper_bound(whens_.begin(), whens_.end(), when) - whens_.begin();
+  whens_.insert(whens_.begin() + position, when);
+  indices_.insert(indices_.begin() + position, index);
+}
+
+void TimeIndex::AddAll(const std::vector<int64_t>& whens, std::size_t begin) {
+  if (begin >= whens.size()) return;
+  std::vector<int> added(whens.size() - begin);
+  for (std::size_t i = 0; i < added.size(); ++i) {
+    added[i] = static_cast<int>(begin + i);
+  }
+  std::stable_sort(added.begin(), added.end(), [&whens](int lhs, int rhs) {
+    return whens[lhs] < whens[rhs];
+  });
+
+  // merge from the back so only the part after the first new time is moved,
+  // the old exchanges stay before new ones with the same time
+  const auto first = static_cast<std::size_t>(std::upper_bound(whens_.begin(), whens_.end(), whens[added.front()]) - whens_.begin());
+  auto old_entry = whens_.size();
+  auto new_entry = added.size();
+  whens_.resize(whens_.size() + added.size());
+  indices_.resize(indices_.size() + added.size());
+  for (auto target = whens_.size(); new_entry > 0; --target) {
+    if (old_entry > first && whens_[old_entry - 1] > whens[added[new_entry - 1]]) {
+      --old_entry;
+      whens_[target - 1] = whens_[old_entry];
+      indices_[target - 1] = indices_[old_entry];
+    }
+    else {
+      --new_entry;
+      whens_[target - 1] = whens[added[new_entry]];
+      indices_[target - 1] = added[new_entry];
+    }
+  }
+}
+
+TimeIndex::Slice TimeIndex::Range(int64_t from, int64_t to) const {
+  if (to <= from) return Slice(indices_.end(), indices_.end());
+  const auto first = std::lower_bound(whens_.begin(), whens_.end(), from) - whens_.begin();
+  const auto last = std::lower_bound(whens_.begin() + first, whens_.end(), to) - whens_.begin();
+  return Slice(indices_.begin() + first, indices_.begin() + last);
+}
+
+TimeIndex::Slice TimeIndex::All() const {
+  return Slice(indices_.begin(), indices_.end());
+}
+
+std::size_t TimeIndex::size() const {
+  return indices_.size();
+}
@@ -0,0 +1,52 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_TIMEINDEX_H_
+#define CORE_TIMEINDEX_H_
+
+#include <cstdint>
+#include <vector>
+
+// indices of exchanges ordered by when, exchanges with the same time keep
+// the order they were added in
+class TimeIndex {
+public:
+  // a part of the index, iterates over exchange indices.
+  // only valid until the index is changed
+  class Slice {
+  public:
+    typedef std::vector<int>::const_iterator const_iterator;
+    Slice(const_iterator begin, const_iterator end);
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    std::size_t size() const;
+    bool empty() const;
+
+  private:
+    const_iterator begin_;
+    const_iterator end_;
+  };
+
+  void Clear();
+
+  // the index of each when is its position in the vector
+  void Build(const std::vector<int64_t>& whens);
+
+  // new exchanges are usually the latest so this is normally a push_back
+  void Add(int64_t when, int index);
+  // adds the exchanges from begin and on, the index of each when is its
+  // position in the vector. sorts the new ones and merges them in once
+  void AddAll(const std::vector<int64_t>& whens, std::size_t begin);
+
+  // the exchanges where from <= when < to
+  Slice Range(int64_t from, int64_t to) const;
+  Slice All() const;
+
+  std::size_t size() const;
+
+private:
+  std::vector<int64_t> whens_;
+  std::vector<int> indices_;
+};
+
+#endif  // CORE_TIMEINDEX_H_
@@ -0,0 +1,42 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_BENCH_BENCH_H_
+#define CORE_BENCH_BENCH_H_
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+class Timer {
+public:
+  Timer() : start_(std::chrono::steady_clock::now()) { }
+
+  double Milliseconds() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+inline void Report(const std::string& name, double milliseconds, int operations) {
+  const auto per_operation = milliseconds * 1000000.0 / operations;
+  std::cout << "  " << name << ": " << milliseconds << " ms, " << per_operation << " ns/op\n";
+}
+
+// keeps the optimizer from removing the benchmarked code
+template<typename T>
+void Use(const T& t) {
+  static volatile T sink;
+  sink = t;
+  // reading it back keeps the compiler from warning that it is never used
+  static_cast<void>(sink);
+}
+
+void BenchNameIndex();
+void BenchEnvelopes();
+void BenchKernels();
+void BenchDateTime();
+void BenchMoneyFormat();
+
+#endif  // CORE_BENCH_BENCH_H_
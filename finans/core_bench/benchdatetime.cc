@@ -0,0 +1,115 @@
+// Copyright (2015) Gustav
+
+#include "finans/core_bench/bench.h"
+
+#include <ctime>
+#include <vector>
+
+#include "finans/core/dateformat.h"
+#include "finans/core/datetime.h"
+#include "finans/core/day.h"
+#include "finans/core/kernels.h"
+
+void BenchDateTime() {
+  const int count = 1000000;
+  std::cout << "Date conversions of " << count << " exchanges\n";
+
+  // three years of exchanges, a couple of hours apart
+  std::vector<int64_t> whens(count);
+  for (int i = 0; i < count; ++i) {
+    whens[i] = 1420070400ll + i * 97ll;
+  }
+
+  {
+    // what MonthStart did before, localtime and mktime for every exchange
+    Timer timer;
+    int64_t sum = 0;
+    for (const auto when : whens) {
+      time_t t = static_cast<time_t>(when);
+      struct tm tt = *localtime(&t);
+      tt.tm_mday = 1;
+      tt.tm_hour = 0;
+      tt.tm_min = 0;
+      tt.tm_sec = 0;
+      tt.tm_isdst = 0;
+      sum += mktime(&tt);
+    }
+    Use(sum);
+    Report("month start libc", timer.Milliseconds(), count);
+  }
+  {
+    Timer timer;
+    UtcOffsetTable table;
+    int64_t sum = 0;
+    for (const auto when : whens) {
+      sum += table.MonthStart(when);
+    }
+    Use(sum);
+    Report("month start offset table", timer.Milliseconds(), count);
+  }
+  {
+    Timer timer;
+    int64_t sum = 0;
+    for (const auto when : whens) {
+      time_t t = static_cast<time_t>(when);
+      const struct tm tt = *gmtime(&t);
+      sum += tt.tm_year + tt.tm_mon + tt.tm_mday;
+    }
+    Use(sum);
+    Report("gmt date libc", timer.Milliseconds(), count);
+  }
+  {
+    Timer timer;
+    int64_t sum = 0;
+    for (const auto when : whens) {
+      const auto date = CivilFromDays(when / (24 * 60 * 60));
+      sum += date.year + date.month + date.day;
+    }
+    Use(sum);
+    Report("gmt date civil", timer.Milliseconds(), count);
+  }
+
+  const KernelLevel levels[] = { KernelLevel::SCALAR, KernelLevel::SSE2, KernelLevel::AVX2 };
+  std::vector<int32_t> days(count);
+  for (const auto level : levels) {
+    if (level > DetectKernelLevel()) continue;
+    Timer timer;
+    SecondsToDays(level, whens.data(), whens.size(), days.data());
+    Use(days[count / 2]);
+    Report(std::string("gmt days column ") + KernelLevelName(level), timer.Milliseconds(), count);
+  }
+  {
+    Timer timer;
+    UtcOffsetTable table;
+    LocalDays(whens.data(), whens.size(), &table, days.data());
+    Use(days[count / 2]);
+    Report("local days column", timer.Milliseconds(), count);
+  }
+
+  {
+    // what StructTmWrapper::ToString did before, a vector and strftime per date
+    Timer timer;
+    std::size_t size = 0;
+    for (const auto when : whens) {
+      time_t t = static_cast<time_t>(when);
+      const struct tm tt = *localtime(&t);
+      std::vector<char> buffer(100);
+      strftime(&buffer[0], buffer.size(), "%Y-%m-%d", &tt);
+      size += std::string(&buffer[0]).size();
+    }
+    Use(size);
+    Report("format date strftime", timer.Milliseconds(), count);
+  }
+  {
+    Timer timer;
+    const DateFormat format("%Y-%m-%d");
+    UtcOffsetTable table;
+    std::string out;
+    for (const auto when : whens) {
+      format.AppendLocal(when, &table, &out);
+      out += '\n';
+    }
+    Use(out.size());
+    Report("format date DateFormat", timer.Milliseconds(), count);
+  }
+}
@@ -0,0 +1,64 @@
+// Copyright (2015) Gustav
+
+#include "finans/core_bench/bench.h"
+
+#include <vector>
+
+#include "finans/core/envelopes.h"
+#include "finans/core/threadpool.h"
+
+namespace {
+struct Exchange {
+  int category;
+  int currency;
+  int64_t value;
+  int64_t when;
+};
+
+// the same chunking as Finans::ReportEnvelopes
+std::vector<EnvelopeRow> Rollup(const std::vector<Exchange>& exchanges, const std::vector<int64_t>& months, int threads) {
+  ThreadPool pool(threads);
+  const auto size = exchanges.size();
+  const auto chunks = static_cast<std::size_t>(pool.size()) * 4;
+  std::vector<EnvelopeAccumulator> sums(chunks);
+  for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+    pool.Add([&exchanges, &months, &sums, chunk, chunks, size]() {
+      for (auto i = size * chunk / chunks; i < size * (chunk + 1) / chunks; ++i) {
+        const auto& e = exchanges[i];
+        sums[chunk].Add(FindMonth(months, e.when), e.category, e.currency, e.value);
+      }
+    });
+  }
+  pool.Wait();
+  for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+    sums[0].Merge(sums[chunk]);
+  }
+  return sums[0].GetRows();
+}
+}  // namespace
+
+void BenchEnvelopes() {
+  const int count = 4000000;
+  const int month_count = 120;
+  std::cout << "Envelope rollup of " << count << " exchanges over " << month_count << " months\n";
+
+  std::vector<int64_t> months;
+  for (int i = 0; i < month_count; ++i) {
+    months.push_back(i * 2629746ll);
+  }
+  std::vector<Exchange> exchanges(count);
+  for (int i = 0; i < count; ++i) {
+    auto& e = exchanges[i];
+    e.category = (i * 31) % 40 - 1;
+    e.currency = i % 3;
+    e.value = (i * 7919) % 100000 - 50000;
+    e.when = static_cast<int64_t>(i) * (month_count * 2629746ll / count);
+  }
+
+  for (int threads = 1; threads <= ThreadPool::NumberOfCores(); threads *= 2) {
+    Timer timer;
+    const auto rows = Rollup(exchanges, months, threads);
+    Use(rows.size());
+    Report(std::to_string(threads) + " threads", timer.Milliseconds(), count);
+  }
+}
@@ -0,0 +1,47 @@
+// Copyright (2015) Gustav
+
+#include "finans/core_bench/bench.h"
+
+#include <vector>
+
+#include "finans/core/kernels.h"
+
+void BenchKernels() {
+  const int count = 10000000;
+  const int repeats = 10;
+  std::cout << "Kernels over " << count << " exchanges, best level is " << KernelLevelName(DetectKernelLevel()) << "\n";
+
+  std::vector<int> values(count);
+  std::vector<int> accounts(count);
+  std::vector<int64_t> whens(count);
+  for (int i = 0; i < count; ++i) {
+    values[i] = (i * 7919) % 200000 - 100000;
+    accounts[i] = i % 16;
+    whens[i] = 1400000000ll + i * 30ll;
+  }
+  const int64_t from = whens[count / 4];
+  const int64_t to = whens[count / 4 * 3];
+
+  const KernelLevel levels[] = { KernelLevel::SCALAR, KernelLevel::SSE2, KernelLevel::AVX2 };
+  for (const auto level : levels) {
+    if (level > DetectKernelLevel()) continue;
+    {
+      Timer timer;
+      int64_t sum = 0;
+      for (int r = 0; r < repeats; ++r) {
+        sum += SumValues(level, values.data(), values.size());
+      }
+      Use(sum);
+      Report(std::string("sum ") + KernelLevelName(level), timer.Milliseconds(), count * repeats);
+    }
+    {
+      Timer timer;
+      int64_t sum = 0;
+      for (int r = 0; r < repeats; ++r) {
+        sum += SumValuesWhere(level, values.data(), accounts.data(), whens.data(), values.size(), r, from, to);
+      }
+      Use(sum);
+      Report(std::string("sum where ") + KernelLevelName(level), timer.Milliseconds(), count * repeats);
+    }
+  }
+}
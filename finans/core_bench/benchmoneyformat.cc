@@ -0,0 +1,44 @@
+// Copyright (2015) Gustav
+
+#include "finans/core_bench/bench.h"
+
+#include <sstream>  // NOLINT this is how we use sstream
+#include <string>
+#include <vector>
+
+#include "finans/core/moneyformat.h"
+
+void BenchMoneyFormat() {
+  const int count = 1000000;
+  std::cout << "Money formatting of " << count << " values\n";
+
+  std::vector<int64_t> values(count);
+  for (int i = 0; i < count; ++i) {
+    values[i] = (i % 2 == 0 ? -1 : 1) * (i * 7919ll % 100000000);
+  }
+
+  {
+    // what the listings did before, a stream per value and the currency after
+    Timer timer;
+    std::size_t size = 0;
+    for (const auto value : values) {
+      const auto abs = value < 0 ? -value : value;
+      std::ostringstream ss;
+      ss << (value < 0 ? "-" : "") << abs / 100 << "." << (abs % 100 < 10 ? "0" : "") << abs % 100 << " " << "SEK";
+      size += ss.str().size();
+    }
+    Use(size);
+    Report("format money ostringstream", timer.Milliseconds(), count);
+  }
+  {
+    Timer timer;
+    const auto format = MoneyFormat::Plain("SEK");
+    std::string out;
+    for (const auto value : values) {
+      format.Append(value, &out);
+      out += '\n';
+    }
+    Use(out.size());
+    Report("format money MoneyFormat", timer.Milliseconds(), count);
+  }
+}
@@ -0,0 +1,60 @@
+// Copyright (2015) Gustav
+
+#include "finans/core_bench/bench.h"
+
+#include <vector>
+
+#include "finans/core/nameindex.h"
+#include "finans/core/stringutils.h"
+
+namespace {
+// the lookup Finans did before it had a index
+int LinearFind(const std::vector<std::string>& names, const std::string& name) {
+  const auto n = ToLower(name);
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    if (ToLower(names[i]) == n) return static_cast<int>(i);
+  }
+  return -1;
+}
+}  // namespace
+
+void BenchNameIndex() {
+  const int count = 100000;
+  std::cout << "Name lookup with " << count << " companies\n";
+
+  std::vector<std::string> names;
+  for (int i = 0; i < count; ++i) {
+    names.push_back("Company " + std::to_string(i));
+  }
+
+  NameIndex index;
+  {
+    Timer timer;
+    for (int i = 0; i < count; ++i) {
+      index.Add(names[i], i);
+    }
+    Report("build index", timer.Milliseconds(), count);
+  }
+
+  // the linear search is too slow to do for every name
+  const int linear_lookups = 200;
+  {
+    Timer timer;
+    int found = 0;
+    for (int i = 0; i < linear_lookups; ++i) {
+      found += LinearFind(names, names[(i * 7919) % count]);
+    }
+    Use(found);
+    Report("linear lookup", timer.Milliseconds(), linear_lookups);
+  }
+
+  {
+    Timer timer;
+    int found = 0;
+    for (int i = 0; i < count; ++i) {
+      found += index.Find(names[(i * 7919) % count]);
+    }
+    Use(found);
+    Report("index lookup", timer.Milliseconds(), count);
+  }
+}
@@ -0,0 +1,12 @@
+// Copyright (2015) Gustav
+
+#include "finans/core_bench/bench.h"
+
+int main() {
+  BenchNameIndex();
+  BenchEnvelopes();
+  BenchKernels();
+  BenchDateTime();
+  BenchMoneyFormat();
+  return 0;
+}
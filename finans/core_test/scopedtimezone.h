@@ -0,0 +1,35 @@
+// Copyright (2015) Gustav
+
+#ifndef CORE_TEST_SCOPEDTIMEZONE_H_
+#define CORE_TEST_SCOPEDTIMEZONE_H_
+
+#ifdef FINANS_UNIX
+
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+// sets the local time zone for the lifetime of the object
+class ScopedTimeZone {
+public:
+  explicit ScopedTimeZone(const std::string& zone) {
+    const char* old = getenv("TZ");
+    had_old_ = old != nullptr;
+    if (had_old_) old_ = old;
+    setenv("TZ", zone.c_str(), 1);
+    tzset();
+  }
+  ~ScopedTimeZone() {
+    if (had_old_) setenv("TZ", old_.c_str(), 1);
+    else unsetenv("TZ");
+    tzset();
+  }
+
+private:
+  bool had_old_;
+  std::string old_;
+};
+
+#endif  // FINANS_UNIX
+
+#endif  // CORE_TEST_SCOPEDTIMEZONE_H_
@@ -0,0 +1,93 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/balancehistory.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+#define GTEST(x) GTEST_TEST(balancehistory, x)
+
+GTEST(TestEmpty) {
+  BalanceHistory h;
+  EXPECT_EQ(0, h.GetBalanceBefore(0, 0, 100));
+  EXPECT_THAT(h.GetBalancesBefore(0, 0, {1, 2}), ElementsAre(0, 0));
+}
+
+GTEST(TestBefore) {
+  BalanceHistory h;
+  h.Add(0, 0, 10, 100);
+  h.Add(0, 0, 20, 50);
+  h.Add(0, 0, 20, -5);
+  h.Add(0, 0, 30, 7);
+  EXPECT_EQ(0, h.GetBalanceBefore(0, 0, 10));
+  EXPECT_EQ(100, h.GetBalanceBefore(0, 0, 11));
+  EXPECT_EQ(100, h.GetBalanceBefore(0, 0, 20));
+  EXPECT_EQ(145, h.GetBalanceBefore(0, 0, 21));
+  EXPECT_EQ(152, h.GetBalanceBefore(0, 0, 1000));
+  EXPECT_EQ(0, h.GetBalanceBefore(0, 1, 1000));
+}
+
+GTEST(TestOutOfOrder) {
+  BalanceHistory h;
+  h.Add(2, 1, 30, 1);
+  h.Add(2, 1, 10, 10);
+  h.Add(2, 1, 20, 100);
+  h.Add(2, 1, 5, 1000);
+  EXPECT_EQ(1000, h.GetBalanceBefore(2, 1, 6));
+  EXPECT_EQ(1010, h.GetBalanceBefore(2, 1, 11));
+  EXPECT_EQ(1110, h.GetBalanceBefore(2, 1, 21));
+  EXPECT_EQ(1111, h.GetBalanceBefore(2, 1, 31));
+}
+
+GTEST(TestSeriesMatchesPoints) {
+  BalanceHistory h;
+  for (int i = 0; i < 100; ++i) {
+    h.Add(0, 0, (i * 37) % 50, i);
+  }
+  std::vector<int64_t> times;
+  for (int64_t t = 3; t < 60; t += 4) {
+    times.push_back(t);
+  }
+  const auto series = h.GetBalancesBefore(0, 0, times);
+  ASSERT_EQ(times.size(), series.size());
+  for (std::size_t i = 0; i < times.size(); ++i) {
+    EXPECT_EQ(h.GetBalanceBefore(0, 0, times[i]), series[i]);
+  }
+}
+
+GTEST(TestAddAllMatchesAdd) {
+  // two accounts, both out of order and in batches on top of existing exchanges
+  std::vector<int> accounts;
+  std::vector<int> currencies;
+  std::vector<int64_t> whens;
+  std::vector<int> values;
+  for (int i = 0; i < 200; ++i) {
+    accounts.push_back(i % 2);
+    currencies.push_back(0);
+    whens.push_back((i * 37) % 90);
+    values.push_back(i + 1);
+  }
+  BalanceHistory one;
+  BalanceHistory all;
+  for (std::size_t i = 0; i < 50; ++i) {
+    one.Add(accounts[i], currencies[i], whens[i], values[i]);
+    all.Add(accounts[i], currencies[i], whens[i], values[i]);
+  }
+  for (std::size_t i = 50; i < accounts.size(); ++i) {
+    one.Add(accounts[i], currencies[i], whens[i], values[i]);
+  }
+  all.AddAll(accounts.data() + 50, currencies.data() + 50, whens.data() + 50, values.data() + 50, accounts.size() - 50);
+
+  for (int account = 0; account < 2; ++account) {
+    int64_t expected = 0;
+    for (int64_t t = 0; t <= 91; ++t) {
+      EXPECT_EQ(expected, one.GetBalanceBefore(account, 0, t));
+      EXPECT_EQ(expected, all.GetBalanceBefore(account, 0, t));
+      for (std::size_t i = 0; i < whens.size(); ++i) {
+        if (accounts[i] == account && whens[i] == t) expected += values[i];
+      }
+    }
+  }
+}
@@ -0,0 +1,73 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/balances.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+#define GTEST(x) GTEST_TEST(balances, x)
+
+GTEST(TestEmpty) {
+  Balances b;
+  EXPECT_EQ(0, b.Get(3, 1));
+  EXPECT_THAT(b.GetCurrencies(3), IsEmpty());
+}
+
+GTEST(TestAdd) {
+  Balances b;
+  b.Add(1, 2, 100);
+  b.Add(1, 2, -30);
+  b.Add(1, 0, 5);
+  EXPECT_EQ(70, b.Get(1, 2));
+  EXPECT_EQ(5, b.Get(1, 0));
+  EXPECT_EQ(0, b.Get(0, 2));
+  EXPECT_THAT(b.GetCurrencies(1), ElementsAre(0, 2));
+}
+
+GTEST(TestNoOverflow) {
+  Balances b;
+  b.Add(0, 0, 2000000000);
+  b.Add(0, 0, 2000000000);
+  EXPECT_EQ(4000000000ll, b.Get(0, 0));
+}
+
+GTEST(TestCompare) {
+  Balances a;
+  Balances b;
+  a.Add(0, 0, 10);
+  EXPECT_TRUE(a != b);
+  b.Add(0, 0, 10);
+  b.Add(4, 1, 0);
+  EXPECT_TRUE(a == b);
+}
+
+GTEST(TestGrowKeepsBalances) {
+  Balances b;
+  b.Add(0, 0, 1);
+  b.Add(2, 1, 2);
+  b.Add(1, 7, 3);
+  b.Add(5, 0, 4);
+  EXPECT_EQ(1, b.Get(0, 0));
+  EXPECT_EQ(2, b.Get(2, 1));
+  EXPECT_EQ(3, b.Get(1, 7));
+  EXPECT_EQ(4, b.Get(5, 0));
+  EXPECT_THAT(b.GetCurrencies(2), ElementsAre(1));
+  EXPECT_THAT(b.GetCurrencies(3), IsEmpty());
+}
+
+GTEST(TestAddAll) {
+  const int accounts[] = { 0, 1, 0, 3 };
+  const int currencies[] = { 2, 0, 2, 9 };
+  const int values[] = { 10, 20, -5, 0 };
+  Balances bulk;
+  bulk.AddAll(accounts, currencies, values, 4);
+  Balances single;
+  for (int i = 0; i < 4; ++i) {
+    single.Add(accounts[i], currencies[i], values[i]);
+  }
+  EXPECT_TRUE(bulk == single);
+  EXPECT_EQ(5, bulk.Get(0, 2));
+  EXPECT_THAT(bulk.GetCurrencies(3), ElementsAre(9));
+}
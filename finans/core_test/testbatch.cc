@@ -0,0 +1,55 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/batch.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+#define GTEST(x) GTEST_TEST(batch, x)
+
+GTEST(TestEmptyAndComments) {
+  std::vector<std::string> args = { "old" };
+  EXPECT_EQ("", ParseBatchLine("   ", &args));
+  EXPECT_THAT(args, IsEmpty());
+  EXPECT_EQ("", ParseBatchLine("# addcategory Food", &args));
+  EXPECT_THAT(args, IsEmpty());
+}
+
+GTEST(TestCommandLine) {
+  std::vector<std::string> args;
+  EXPECT_EQ("", ParseBatchLine("addcurrency \"American Dollar\" USD $ ''", &args));
+  EXPECT_THAT(args, ElementsAre("addcurrency", "American Dollar", "USD", "$", ""));
+}
+
+GTEST(TestCommandLineEscapes) {
+  std::vector<std::string> args;
+  EXPECT_EQ("", ParseBatchLine("addcompany Ben\\ \\&\\ Jerry \"say \\\"hi\\\"\"", &args));
+  EXPECT_THAT(args, ElementsAre("addcompany", "Ben & Jerry", "say \"hi\""));
+}
+
+GTEST(TestMissingQuote) {
+  std::vector<std::string> args;
+  EXPECT_NE("", ParseBatchLine("addcategory \"Food", &args));
+}
+
+GTEST(TestJson) {
+  std::vector<std::string> args;
+  EXPECT_EQ("", ParseBatchLine("[\"addcompany\", \"Acme Inc\", \"USD\"]", &args));
+  EXPECT_THAT(args, ElementsAre("addcompany", "Acme Inc", "USD"));
+}
+
+GTEST(TestJsonNumbers) {
+  std::vector<std::string> args;
+  EXPECT_EQ("", ParseBatchLine("[\"addrate\", \"USD\", \"SEK\", 10.5]", &args));
+  EXPECT_THAT(args, ElementsAre("addrate", "USD", "SEK", "10.5"));
+  EXPECT_EQ("", ParseBatchLine("[\"addrate\", \"USD\", \"SEK\", 0.1, 8, -2.5e-7]", &args));
+  EXPECT_THAT(args, ElementsAre("addrate", "USD", "SEK", "0.1", "8", "-2.5e-07"));
+}
+
+GTEST(TestInvalidJson) {
+  std::vector<std::string> args;
+  EXPECT_NE("", ParseBatchLine("[\"addcompany\", ", &args));
+  EXPECT_NE("", ParseBatchLine("[\"addcompany\", {}]", &args));
+}
@@ -0,0 +1,111 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/csvimport.h"
+
+#include <string>
+
+#include "finans/core/datetime.h"
+#include "finans/core/stringutils.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+#define GTEST(x) GTEST_TEST(csvimport, x)
+
+namespace {
+int64_t Day(int year, int month, int day) {
+  return static_cast<int64_t>(DateTimeToInt64(DateTime::FromDateTime(year, IntToMonth(month - 1), day, 0, 0, 0).time()));
+}
+
+std::string Parse(const std::string& csv, const NameIndex& companies, int threads, CsvImport* result) {
+  return ParseCsv(csv.data(), csv.size(), CsvFormat(), companies, threads, result);
+}
+}  // namespace
+
+GTEST(TestTokenizeRanges) {
+  const std::string line = "a,,b,c";
+  StringRange tokens[2];
+  EXPECT_EQ(4u, Tokenize(line.data(), line.data() + line.size(), ",", false, tokens, 2));
+  EXPECT_EQ("a", tokens[0].str());
+  EXPECT_EQ("", tokens[1].str());
+  EXPECT_EQ(3u, Tokenize(line.data(), line.data() + line.size(), ",", true, tokens, 2));
+  EXPECT_EQ("b", tokens[1].str());
+}
+
+GTEST(TestParseCents) {
+  int cents = 0;
+  const std::string negative = "-1234.50";
+  EXPECT_TRUE(ParseCents(negative.data(), negative.data() + negative.size(), &cents));
+  EXPECT_EQ(-123450, cents);
+  const std::string swedish = "1 234,5";
+  EXPECT_TRUE(ParseCents(swedish.data(), swedish.data() + swedish.size(), &cents));
+  EXPECT_EQ(123450, cents);
+  const std::string english = "1,234";
+  EXPECT_TRUE(ParseCents(english.data(), english.data() + english.size(), &cents));
+  EXPECT_EQ(123400, cents);
+  const std::string bad = "12a";
+  EXPECT_FALSE(ParseCents(bad.data(), bad.data() + bad.size(), &cents));
+}
+
+GTEST(TestParseRows) {
+  NameIndex companies;
+  companies.Add("ICA", 0);
+  CsvImport result;
+  const auto error = Parse("date,payee,amount\r\n2015-03-01,ica,-10.50\r\n\r\n2015-03-02, \"Rent\" ,-5000\n2015-03-03,rent,1\n", companies, 1, &result);
+  EXPECT_EQ("", error);
+  ASSERT_EQ(3u, result.rows.size());
+  EXPECT_EQ(Day(2015, 3, 1), result.rows[0].when);
+  EXPECT_EQ(-1050, result.rows[0].value);
+  EXPECT_EQ(0, result.rows[0].company);
+  EXPECT_EQ(-1, result.rows[1].company);
+  EXPECT_EQ(0, result.rows[1].payee);
+  EXPECT_EQ(0, result.rows[2].payee);
+  EXPECT_THAT(result.new_payees, ElementsAre("Rent"));
+}
+
+GTEST(TestThreadedMatchesSingleThreaded) {
+  std::string csv = "date,payee,amount\n";
+  for (int i = 0; i < 20000; ++i) {
+    csv += "2015-0" + std::to_string(1 + i % 9) + "-1" + std::to_string(i % 10) + ",payee " + std::to_string(i % 37) + "," + std::to_string(i) + ".25\n";
+  }
+  NameIndex companies;
+  CsvImport single;
+  CsvImport threaded;
+  EXPECT_EQ("", Parse(csv, companies, 1, &single));
+  EXPECT_EQ("", Parse(csv, companies, 4, &threaded));
+  ASSERT_EQ(20000u, threaded.rows.size());
+  EXPECT_EQ(single.new_payees, threaded.new_payees);
+  EXPECT_EQ(37u, threaded.new_payees.size());
+  for (std::size_t i = 0; i < single.rows.size(); ++i) {
+    EXPECT_EQ(single.rows[i].when, threaded.rows[i].when);
+    EXPECT_EQ(single.rows[i].value, threaded.rows[i].value);
+    EXPECT_EQ(single.rows[i].payee, threaded.rows[i].payee);
+  }
+}
+
+GTEST(TestErrorReportsLine) {
+  NameIndex companies;
+  CsvImport result;
+  EXPECT_EQ("line 3: Invalid date 2015-13-01", Parse("date,payee,amount\n2015-01-01,a,1\n2015-13-01,b,2\n", companies, 2, &result));
+  EXPECT_EQ("line 2: Expected at least 3 columns", Parse("date,payee,amount\n2015-01-01,a\n", companies, 1, &result));
+}
+
+GTEST(TestFirstErrorWins) {
+  NameIndex companies;
+  CsvImport result;
+  EXPECT_EQ("line 2: Invalid date 2015-01-32", Parse("date,payee,amount\n2015-01-32,a,1\n2015-01-01,b,x\n", companies, 1, &result));
+  EXPECT_EQ("line 2: Invalid amount x", Parse("date,payee,amount\n2015-01-01,a,x\n2015-01-32,b,1\n", companies, 1, &result));
+}
+
+GTEST(TestDayMonthYear) {
+  NameIndex companies;
+  CsvImport result;
+  CsvFormat format;
+  format.date_order = DateOrder::DAY_MONTH_YEAR;
+  const std::string csv = "date,payee,amount\n01/03/2015,a,1\n";
+  EXPECT_EQ("", ParseCsv(csv.data(), csv.size(), format, companies, 1, &result));
+  ASSERT_EQ(1u, result.rows.size());
+  EXPECT_EQ(Day(2015, 3, 1), result.rows[0].when);
+}
@@ -2,6 +2,12 @@
 
 #include "finans/core/datetime.h"
 
+#include <string>
+#include <vector>
+
+#include "finans/core/threadpool.h"
+#include "finans/core_test/scopedtimezone.h"
+
 #include "gtest/gtest.h"
 
 #define GTEST(x) GTEST_TEST(datetime, x)
@@ -57,3 +63,85 @@ GTEST(TestChangeMembers) {
   EXPECT_EQ(33, dt.minutes());
   EXPECT_EQ(42, dt.seconds());
 }
+
+//////////////////////////////////////////////////////////////////////////
+
+static_assert(DaysFromCivil(1970, 1, 1) == 0, "epoch");
+static_assert(DaysFromCivil(2000, 3, 1) == 11017, "after a leap day");
+static_assert(CivilFromDays(11016).month == 2 && CivilFromDays(11016).day == 29, "leap day");
+static_assert(CivilFromDays(-1).year == 1969, "before the epoch");
+
+GTEST(TestCivilRoundTrip) {
+  for (int64_t days = -800000; days < 800000; days += 7) {
+    const auto date = CivilFromDays(days);
+    ASSERT_EQ(days, DaysFromCivil(date.year, date.month, date.day));
+    ASSERT_GE(date.day, 1);
+    ASSERT_LE(date.day, DaysInMonth(date.year, date.month));
+  }
+}
+
+GTEST(TestGmtIsArithmetic) {
+  const auto dt = DateTime::FromDateTime(2016, Month::FEBRUARY, 29, 23, 59, 58, TimeZone::GMT);
+  EXPECT_EQ(1456790398u, DateTimeToInt64(dt.time()));
+  EXPECT_EQ("2016-02-29 23:59:58 Mon 060", dt.ToString("%Y-%m-%d %H:%M:%S %a %j"));
+  // out of range fields roll over like mktime
+  const auto next = DateTime::FromDateTime(2016, Month::DECEMBER, 32, 0, 0, 0, TimeZone::GMT);
+  EXPECT_EQ(2017, next.year());
+  EXPECT_EQ(Month::JANUARY, next.month());
+  EXPECT_EQ(1, next.day_of_moth());
+  const auto before = Int64ToDateTime(static_cast<uint64_t>(-1)).ToGmt();
+  EXPECT_EQ("1969-12-31 23:59:59", before.DebugString());
+}
+
+GTEST(TestLocalTimeOnThreads) {
+  // with a shared localtime buffer the threads would read each others dates
+  const int threads = 4;
+  const int count = 20000;
+  std::vector<std::vector<std::string>> results(threads);
+  ThreadPool pool(threads);
+  for (int thread = 0; thread < threads; ++thread) {
+    std::vector<std::string>* result = &results[thread];
+    pool.Add([thread, result]() {
+      for (int i = 0; i < count; ++i) {
+        const auto when = 1420070400ll + (thread * count + i) * 86400ll / 7;
+        result->push_back(Int64ToDateTime(static_cast<uint64_t>(when)).ToLocalTime().DebugString());
+      }
+    });
+  }
+  pool.Wait();
+  for (int thread = 0; thread < threads; ++thread) {
+    for (int i = 0; i < count; i += 101) {
+      const auto when = 1420070400ll + (thread * count + i) * 86400ll / 7;
+      ASSERT_EQ(Int64ToDateTime(static_cast<uint64_t>(when)).ToLocalTime().DebugString(), results[thread][i]);
+    }
+  }
+}
+
+#ifdef FINANS_UNIX
+GTEST(TestOffsetTableMatchesLocalTime) {
+  ScopedTimeZone zone("Europe/Stockholm");
+  UtcOffsetTable table;
+  // every 20 minutes of 2015, both dst changes are in there
+  const int64_t start = 1420070400;
+  for (int64_t when = start; when < start + 365 * 24 * 3600; when += 20 * 60 + 7) {
+    const auto local = Int64ToDateTime(static_cast<uint64_t>(when)).ToLocalTime();
+    const auto date = table.LocalDate(when);
+    ASSERT_EQ(local.year(), date.year) << when;
+    ASSERT_EQ(MonthToInt(local.month()) + 1, date.month) << when;
+    ASSERT_EQ(local.day_of_moth(), date.day) << when;
+    // local midnight of the first, also in summer time
+    const auto month = Int64ToDateTime(static_cast<uint64_t>(table.MonthStart(when))).ToLocalTime();
+    ASSERT_EQ(local.month(), month.month()) << when;
+    ASSERT_EQ(1, month.day_of_moth()) << when;
+    ASSERT_EQ(0, month.hour()) << when;
+    ASSERT_EQ(0, month.minutes()) << when;
+  }
+  // the change to summer time, 2015-03-29 01:00 utc
+  EXPECT_EQ(3600, table.Offset(1427590799));
+  EXPECT_EQ(7200, table.Offset(1427590800));
+  // both days of change start at midnight
+  EXPECT_EQ(1427583600, table.Midnight(DaysFromCivil(2015, 3, 29)));
+  EXPECT_EQ(1445724000, table.Midnight(DaysFromCivil(2015, 10, 25)));
+  EXPECT_EQ(1445814000, table.Midnight(DaysFromCivil(2015, 10, 26)));
+}
+#endif
@@ -0,0 +1,63 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/dateformat.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#define GTEST(x) GTEST_TEST(dateformat, x)
+
+namespace {
+std::string Gmt(const std::string& format, int64_t when) {
+  std::string out;
+  DateFormat(format).AppendGmt(when, &out);
+  return out;
+}
+
+// 2016-02-29 07:08:09 utc, a monday
+const int64_t WHEN = 1456729689;
+}  // namespace
+
+GTEST(TestFastPaths) {
+  EXPECT_EQ("2016-02-29", Gmt("%Y-%m-%d", WHEN));
+  EXPECT_EQ("2016-02-29 07:08:09", Gmt("%Y-%m-%d %H:%M:%S", WHEN));
+  EXPECT_EQ("2016-02-29 07:08:09", Gmt("%F %T", WHEN));
+  EXPECT_EQ("1969-12-31", Gmt("%F", -1));
+}
+
+GTEST(TestGeneric) {
+  EXPECT_EQ("29/02/16 07h 100%", Gmt("%d/%m/%y %Hh 100%%", WHEN));
+  EXPECT_EQ("Mon 060 2016", Gmt("%a %j %Y", WHEN));
+  EXPECT_EQ("", Gmt("", WHEN));
+}
+
+GTEST(TestAppends) {
+  const DateFormat format("%Y-%m-%d");
+  std::string out = "x ";
+  format.AppendGmt(0, &out);
+  out += " ";
+  format.Append(Day::FromCivil(2015, 3, 2), &out);
+  EXPECT_EQ("x 1970-01-01 2015-03-02", out);
+}
+
+GTEST(TestMatchesStrftime) {
+  UtcOffsetTable local_time;
+  for (int64_t when = 1420070400; when < 1420070400 + 400 * 86400; when += 86400 / 3 + 17) {
+    const auto local = Int64ToDateTime(static_cast<uint64_t>(when)).ToLocalTime();
+    std::string out;
+    DateFormat("%Y-%m-%d %H:%M:%S").AppendLocal(when, &local_time, &out);
+    ASSERT_EQ(local.DebugString(), out);
+    // DebugString itself goes through DateFormat now, so check strftime directly too
+    char buffer[64];
+    const time_t t = static_cast<time_t>(when);
+    struct tm tt;
+#ifdef FINANS_WINDOWS
+    localtime_s(&tt, &t);
+#else
+    localtime_r(&t, &tt);
+#endif
+    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tt);
+    ASSERT_EQ(std::string(buffer), out);
+  }
+}
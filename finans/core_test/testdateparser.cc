@@ -0,0 +1,112 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/dateparser.h"
+
+#include <string>
+#include <vector>
+
+#include "finans/core_test/scopedtimezone.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+#define GTEST(x) GTEST_TEST(dateparser, x)
+
+namespace {
+bool Parse(const std::string& text, DateOrder order, ParsedDate* date) {
+  return ParseDate(text.data(), text.data() + text.size(), order, date);
+}
+
+int64_t ParseGmt(const std::string& text, DateOrder order) {
+  DateParser parser(order, TimeZone::GMT);
+  int64_t when = -1;
+  EXPECT_TRUE(parser.Parse(text.data(), text.data() + text.size(), &when)) << text;
+  return when;
+}
+}  // namespace
+
+GTEST(TestDaysFromCivil) {
+  EXPECT_EQ(0, DaysFromCivil(1970, 1, 1));
+  EXPECT_EQ(-1, DaysFromCivil(1969, 12, 31));
+  EXPECT_EQ(11016, DaysFromCivil(2000, 2, 29));
+  EXPECT_EQ(16494, DaysFromCivil(2015, 2, 28));
+  EXPECT_EQ(29, DaysInMonth(2000, 2));
+  EXPECT_EQ(28, DaysInMonth(1900, 2));
+}
+
+GTEST(TestFormats) {
+  ParsedDate d;
+  ASSERT_TRUE(Parse("2015-03-07", DateOrder::YEAR_MONTH_DAY, &d));
+  EXPECT_EQ(2015, d.year);
+  EXPECT_EQ(3, d.month);
+  EXPECT_EQ(7, d.day);
+  EXPECT_EQ(0, d.seconds);
+  ASSERT_TRUE(Parse("20150307", DateOrder::YEAR_MONTH_DAY, &d));
+  EXPECT_EQ(7, d.day);
+  ASSERT_TRUE(Parse("7.3.2015", DateOrder::DAY_MONTH_YEAR, &d));
+  EXPECT_EQ(3, d.month);
+  EXPECT_EQ(7, d.day);
+  ASSERT_TRUE(Parse("03/07/2015", DateOrder::MONTH_DAY_YEAR, &d));
+  EXPECT_EQ(3, d.month);
+  EXPECT_EQ(7, d.day);
+  ASSERT_TRUE(Parse("2015-03-07T10:20:30", DateOrder::YEAR_MONTH_DAY, &d));
+  EXPECT_EQ(10 * 3600 + 20 * 60 + 30, d.seconds);
+  ASSERT_TRUE(Parse("07/03/2015 10:20", DateOrder::DAY_MONTH_YEAR, &d));
+  EXPECT_EQ(10 * 3600 + 20 * 60, d.seconds);
+}
+
+GTEST(TestInvalid) {
+  ParsedDate d;
+  EXPECT_FALSE(Parse("", DateOrder::YEAR_MONTH_DAY, &d));
+  EXPECT_FALSE(Parse("2015-02-29", DateOrder::YEAR_MONTH_DAY, &d));
+  EXPECT_FALSE(Parse("2015-13-01", DateOrder::YEAR_MONTH_DAY, &d));
+  EXPECT_FALSE(Parse("2015-03/07", DateOrder::YEAR_MONTH_DAY, &d));
+  EXPECT_FALSE(Parse("2015-03-07x", DateOrder::YEAR_MONTH_DAY, &d));
+  EXPECT_FALSE(Parse("2015-03-07T25:00", DateOrder::YEAR_MONTH_DAY, &d));
+  EXPECT_FALSE(Parse("07/03/15", DateOrder::DAY_MONTH_YEAR, &d));
+}
+
+GTEST(TestGmtIsArithmetic) {
+  EXPECT_EQ(0, ParseGmt("1970-01-01", DateOrder::YEAR_MONTH_DAY));
+  EXPECT_EQ(1425297600, ParseGmt("02/03/2015 12:00", DateOrder::DAY_MONTH_YEAR));
+}
+
+GTEST(TestLocalMatchesDateTime) {
+  DateParser parser(DateOrder::YEAR_MONTH_DAY, TimeZone::LOCAL);
+  const std::vector<std::string> text = { "2015-03-02", "2015-03-02", "2015-07-15", "2015-07-15T08:00:00" };
+  std::vector<StringRange> dates;
+  for (const auto& t : text) dates.push_back(StringRange{ t.data(), t.data() + t.size() });
+  std::vector<int64_t> whens(dates.size());
+  ASSERT_EQ(dates.size(), parser.ParseAll(dates.data(), dates.size(), whens.data()));
+  const auto march = static_cast<int64_t>(DateTimeToInt64(DateTime::FromDateTime(2015, Month::MARCH, 2, 0, 0, 0).time()));
+  const auto july = static_cast<int64_t>(DateTimeToInt64(DateTime::FromDateTime(2015, Month::JULY, 15, 0, 0, 0).time()));
+  EXPECT_EQ(march, whens[0]);
+  EXPECT_EQ(march, whens[1]);
+  EXPECT_EQ(july, whens[2]);
+  EXPECT_EQ(july + 8 * 3600, whens[3]);
+
+  const std::string bad = "2015-02-30";
+  dates[1] = StringRange{ bad.data(), bad.data() + bad.size() };
+  EXPECT_EQ(1u, parser.ParseAll(dates.data(), dates.size(), whens.data()));
+}
+
+#ifdef FINANS_UNIX
+GTEST(TestLocalTimeOnDaylightSavingChanges) {
+  ScopedTimeZone zone("Europe/Stockholm");
+  DateParser parser(DateOrder::YEAR_MONTH_DAY, TimeZone::LOCAL);
+  const auto parse = [&parser](const std::string& text) {
+    int64_t when = 0;
+    EXPECT_TRUE(parser.Parse(text.data(), text.data() + text.size(), &when));
+    return when;
+  };
+  // summer time starts at 01:00 utc on 2015-03-29 and ends at 01:00 utc on 2015-10-25
+  EXPECT_EQ(1427583600, parse("2015-03-29"));
+  EXPECT_EQ(1427587200, parse("2015-03-29 01:00"));
+  EXPECT_EQ(1427623200, parse("2015-03-29 12:00"));
+  EXPECT_EQ(1445724000, parse("2015-10-25"));
+  EXPECT_EQ(1445770800, parse("2015-10-25 12:00"));
+  EXPECT_EQ(1445813999, parse("2015-10-25 23:59:59"));
+}
+#endif
@@ -0,0 +1,64 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/day.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#define GTEST(x) GTEST_TEST(day, x)
+
+static_assert(Day::FromCivil(1970, 1, 1).days() == 0, "epoch");
+static_assert(Day::FromCivil(2015, 3, 2).weekday() == Weekday::MONDAY, "weekday");
+static_assert(Day::FromGmt(-1).days() == -1, "rounds down");
+static_assert(Day::FromCivil(2016, 2, 10).MonthEnd() == Day::FromCivil(2016, 2, 29), "leap year");
+
+GTEST(TestFields) {
+  const auto day = Day::FromCivil(2015, 12, 31);
+  EXPECT_EQ(2015, day.year());
+  EXPECT_EQ(12, day.month());
+  EXPECT_EQ(31, day.day());
+  EXPECT_EQ(Weekday::THURSDAY, day.weekday());
+  EXPECT_EQ(Day::FromCivil(2015, 12, 1), day.MonthStart());
+  EXPECT_EQ(Day::FromCivil(2016, 1, 1), day + 1);
+  EXPECT_EQ(365, Day::FromCivil(2016, 1, 1) - Day::FromCivil(2015, 1, 1));
+  EXPECT_EQ(Weekday::SUNDAY, Day::FromCivil(1969, 12, 28).weekday());
+}
+
+GTEST(TestIsoWeek) {
+  // 2015-12-31 is in week 53 of 2015, 2016-01-03 too
+  EXPECT_EQ(53, Day::FromCivil(2015, 12, 31).IsoWeek());
+  EXPECT_EQ(53, Day::FromCivil(2016, 1, 3).IsoWeek());
+  EXPECT_EQ(2015, Day::FromCivil(2016, 1, 3).IsoWeekYear());
+  EXPECT_EQ(1, Day::FromCivil(2016, 1, 4).IsoWeek());
+  // 2014-12-29 is in week 1 of 2015
+  EXPECT_EQ(1, Day::FromCivil(2014, 12, 29).IsoWeek());
+  EXPECT_EQ(2015, Day::FromCivil(2014, 12, 29).IsoWeekYear());
+  EXPECT_EQ(52, Day::FromCivil(2014, 12, 28).IsoWeek());
+}
+
+GTEST(TestDateTime) {
+  const auto day = Day::FromCivil(2015, 7, 14);
+  const auto dt = day.ToDateTime(TimeZone::GMT);
+  EXPECT_EQ(day.GmtStart(), static_cast<int64_t>(DateTimeToInt64(dt.time())));
+  EXPECT_EQ(day, Day::FromDateTime(dt));
+
+  UtcOffsetTable local_time;
+  const auto local = day.ToDateTime(TimeZone::LOCAL);
+  EXPECT_EQ(static_cast<int64_t>(DateTimeToInt64(local.time())), day.LocalStart(&local_time));
+  EXPECT_EQ(day, Day::FromLocal(day.LocalStart(&local_time) + 3600, &local_time));
+}
+
+GTEST(TestBatch) {
+  std::vector<int64_t> whens;
+  for (int64_t when = -100000; when < 10000000; when += 3607) whens.push_back(when);
+  std::vector<int32_t> gmt(whens.size());
+  std::vector<int32_t> local(whens.size());
+  UtcOffsetTable local_time;
+  GmtDays(whens.data(), whens.size(), gmt.data());
+  LocalDays(whens.data(), whens.size(), &local_time, local.data());
+  for (std::size_t i = 0; i < whens.size(); ++i) {
+    ASSERT_EQ(Day::FromGmt(whens[i]).days(), gmt[i]);
+    ASSERT_EQ(Day::FromLocal(whens[i], &local_time).days(), local[i]);
+  }
+}
@@ -0,0 +1,51 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/envelopes.h"
+
+#include "gtest/gtest.h"
+
+#define GTEST(x) GTEST_TEST(envelopes, x)
+
+GTEST(TestFindMonth) {
+  const std::vector<int64_t> months = { 100, 200, 300 };
+  EXPECT_EQ(0, FindMonth(months, 50));
+  EXPECT_EQ(0, FindMonth(months, 100));
+  EXPECT_EQ(0, FindMonth(months, 199));
+  EXPECT_EQ(1, FindMonth(months, 200));
+  EXPECT_EQ(2, FindMonth(months, 5000));
+}
+
+GTEST(TestRowsAreSorted) {
+  EnvelopeAccumulator a;
+  a.Add(1, 2, 0, 10);
+  a.Add(0, 5, 1, 20);
+  a.Add(0, -1, 0, 30);
+  a.Add(0, 5, 0, 40);
+  a.Add(0, 5, 0, 1);
+  const auto rows = a.GetRows();
+  ASSERT_EQ(4u, rows.size());
+  EXPECT_EQ(0, rows[0].month);
+  EXPECT_EQ(-1, rows[0].category);
+  EXPECT_EQ(30, rows[0].sum);
+  EXPECT_EQ(5, rows[1].category);
+  EXPECT_EQ(0, rows[1].currency);
+  EXPECT_EQ(41, rows[1].sum);
+  EXPECT_EQ(2, rows[1].count);
+  EXPECT_EQ(1, rows[2].currency);
+  EXPECT_EQ(1, rows[3].month);
+  EXPECT_EQ(2, rows[3].category);
+}
+
+GTEST(TestMerge) {
+  EnvelopeAccumulator a;
+  EnvelopeAccumulator b;
+  a.Add(0, 0, 0, 5);
+  b.Add(0, 0, 0, -2);
+  b.Add(3, 1, 0, 7);
+  a.Merge(b);
+  const auto rows = a.GetRows();
+  ASSERT_EQ(2u, rows.size());
+  EXPECT_EQ(3, rows[0].sum);
+  EXPECT_EQ(2, rows[0].count);
+  EXPECT_EQ(7, rows[1].sum);
+}
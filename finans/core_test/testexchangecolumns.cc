@@ -0,0 +1,33 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/exchangecolumns.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+#define GTEST(x) GTEST_TEST(exchangecolumns, x)
+
+GTEST(TestEmpty) {
+  ExchangeColumns c;
+  EXPECT_TRUE(c.empty());
+  EXPECT_EQ(0u, c.size());
+}
+
+GTEST(TestColumnsStayAligned) {
+  ExchangeColumns c;
+  c.Add(1, 2, 3, -1, 100, 1000);
+  c.Add(4, 5, 6, 7, -50, 2000);
+  ASSERT_EQ(2u, c.size());
+  EXPECT_THAT(c.accounts(), ElementsAre(1, 4));
+  EXPECT_THAT(c.currencies(), ElementsAre(2, 5));
+  EXPECT_THAT(c.companies(), ElementsAre(3, 6));
+  EXPECT_THAT(c.categories(), ElementsAre(-1, 7));
+  EXPECT_THAT(c.values(), ElementsAre(100, -50));
+  EXPECT_THAT(c.whens(), ElementsAre(1000, 2000));
+
+  c.Clear();
+  EXPECT_TRUE(c.empty());
+  EXPECT_THAT(c.values(), IsEmpty());
+}
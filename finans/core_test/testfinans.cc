@@ -0,0 +1,446 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/finans.h"
+
+#ifdef FINANS_UNIX
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#include <cstdio>
+#include <fstream>  // NOLINT this is how we use fstrean
+#include <iterator>
+#include <limits>
+#include <string>
+
+#include "finans/core/file.h"
+#include "finans/core/finans-proto.h"
+#include "finans/core/proto.h"
+#include "finans/core_test/scopedtimezone.h"
+
+#include "gtest/gtest.h"
+
+#define GTEST(x) GTEST_TEST(finans, x)
+
+namespace {
+// the journal is always next to the snapshot
+const std::string SNAPSHOT = "testfinans.json";
+const std::string JOURNAL = "finans.journal";
+const std::string STATEMENT = "teststatement.csv";
+const std::string CACHE = "testfinans.cache";
+const uint64_t JOURNAL_LIMIT = 4 * 1024 * 1024;
+
+void WriteFile(const std::string& path, const std::string& content) {
+  std::ofstream f(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  f << content;
+}
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream f(path.c_str(), std::ios::in | std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+void RemoveLedger() {
+  std::remove(SNAPSHOT.c_str());
+  std::remove(JOURNAL.c_str());
+  std::remove(CACHE.c_str());
+}
+
+std::shared_ptr<Finans> OpenNew() {
+  RemoveLedger();
+  WriteFile(SNAPSHOT, "{}");
+  return Finans::Open(SNAPSHOT, SnapshotFormat::JSON, "", JOURNAL_LIMIT);
+}
+
+std::shared_ptr<Finans> Reopen(uint64_t journal_limit = JOURNAL_LIMIT) {
+  return Finans::Open(SNAPSHOT, SnapshotFormat::JSON, "", journal_limit);
+}
+
+std::shared_ptr<Finans> OpenCached() {
+  return Finans::Open(SNAPSHOT, SnapshotFormat::JSON, CACHE, JOURNAL_LIMIT);
+}
+
+std::shared_ptr<Finans> OpenWithAccount() {
+  auto f = OpenNew();
+  f->AddCurency("Swedish krona", "SEK", "", "kr");
+  f->AddAccount("Bank", "bank", 0);
+  f->AddCompany("shop", 0);
+  return f;
+}
+
+// the end of each day of march 2015 where day d has a exchange of d kr
+void ExpectMarchBalances(const Finans& f) {
+  const auto balances = f.GetDailyBalances(0, 0, Day::FromCivil(2015, 3, 1), 30);
+  ASSERT_EQ(30u, balances.size());
+  int64_t sum = 0;
+  for (int day = 1; day <= 30; ++day) {
+    sum += day * 100;
+    EXPECT_EQ(sum, balances[day - 1]);
+  }
+}
+}  // namespace
+
+GTEST(TestImportNewestFirst) {
+  std::string csv = "date,payee,amount\n";
+  for (int day = 30; day >= 1; --day) {
+    csv += "2015-03-" + std::string(day < 10 ? "0" : "") + std::to_string(day) + ",shop," + std::to_string(day) + ".00\n";
+  }
+  WriteFile(STATEMENT, csv);
+
+  auto f = OpenWithAccount();
+  // the import goes to the journal and not the snapshot
+  f->Save();
+  EXPECT_EQ(30, f->ImportCsv(STATEMENT, 0, CsvFormat(), 1, nullptr, nullptr));
+
+  const auto all = f->GetExternalExchangesBetween(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+  ASSERT_EQ(30u, all.size());
+  int64_t last = std::numeric_limits<int64_t>::min();
+  for (const auto index : all) {
+    EXPECT_LE(last, f->GetExternalExchange(index).when);
+    last = f->GetExternalExchange(index).when;
+  }
+  EXPECT_TRUE(f->VerifyBalances());
+  ExpectMarchBalances(*f);
+
+  // and the same after the journal is replayed
+  f->Save();
+  f = Reopen();
+  EXPECT_EQ(30, f->load_timing().journal_records);
+  EXPECT_EQ(30, f->NumberOfExternalExchanges());
+  ExpectMarchBalances(*f);
+
+  std::remove(STATEMENT.c_str());
+  RemoveLedger();
+}
+
+GTEST(TestDailyBalancesOfNoDays) {
+  auto f = OpenWithAccount();
+  EXPECT_TRUE(f->GetDailyBalances(0, 0, Day::FromCivil(2015, 3, 1), 0).empty());
+  EXPECT_ANY_THROW(f->GetDailyBalances(0, 0, Day::FromCivil(2015, 3, 1), -31));
+  RemoveLedger();
+}
+
+GTEST(TestJournalIsReplayedOnTheSnapshot) {
+  auto f = OpenWithAccount();
+  f->Save();
+  const auto snapshot = ReadFile(SNAPSHOT);
+
+  f->AddExternalExchange(0, 0, -1, 100, 1425168000);
+  f->Save();
+  f->AddExternalExchange(0, 0, -1, 200, 1425254400);
+  f->AddCategory("food");
+  f->Save();
+  // small saves only append to the journal
+  EXPECT_EQ(snapshot, ReadFile(SNAPSHOT));
+
+  f = Reopen();
+  EXPECT_EQ(3, f->load_timing().journal_records);
+  EXPECT_EQ(2, f->NumberOfExternalExchanges());
+  EXPECT_EQ(1, f->NumberOfCategories());
+  EXPECT_EQ(300, f->GetBalance(0, 0));
+  EXPECT_TRUE(f->VerifyBalances());
+  RemoveLedger();
+}
+
+GTEST(TestJournalOfAOlderSnapshotIsSkipped) {
+  auto f = OpenWithAccount();
+  f->Save();
+  f->AddExternalExchange(0, 0, -1, 100, 1425168000);
+  f->Save();
+  const auto old_journal = ReadFile(JOURNAL);
+
+  // the exchange is folded into a new snapshot, then the old journal comes back
+  f->Compact();
+  f.reset();
+  WriteFile(JOURNAL, old_journal);
+
+  f = Reopen();
+  EXPECT_EQ(0, f->load_timing().journal_records);
+  EXPECT_EQ(1, f->NumberOfExternalExchanges());
+  EXPECT_EQ(100, f->GetBalance(0, 0));
+
+  // and the next save replaces it instead of appending to it
+  f->AddExternalExchange(0, 0, -1, 200, 1425254400);
+  f->Save();
+  f = Reopen();
+  EXPECT_EQ(2, f->NumberOfExternalExchanges());
+  EXPECT_EQ(300, f->GetBalance(0, 0));
+  RemoveLedger();
+}
+
+GTEST(TestJournalIsCompactedAtTheLimit) {
+  const uint64_t limit = 200;
+  auto f = OpenWithAccount();
+  f->Save();
+  f = Reopen(limit);
+  for (int i = 0; i < 50; ++i) {
+    f->AddExternalExchange(0, 0, -1, 100, 1425168000 + i * 3600);
+    f->Save();
+    EXPECT_LT(ReadFile(JOURNAL).size(), limit);
+  }
+
+  f = Reopen(limit);
+  EXPECT_EQ(50, f->NumberOfExternalExchanges());
+  EXPECT_EQ(5000, f->GetBalance(0, 0));
+  // most of them are in the snapshot
+  EXPECT_LT(f->load_timing().journal_records, 10);
+  RemoveLedger();
+}
+
+GTEST(TestMoneyWithoutCountsIsRebuilt) {
+  RemoveLedger();
+  const std::string ledger =
+    "{\"currencies\": [{\"full_name\": \"Swedish krona\", \"short_name\": \"SEK\"}],"
+    " \"accounts\": [{\"long_name\": \"Bank\", \"short_name\": \"bank\", \"prefered_currency\": 0,"
+    " \"money\": [{\"currency\": 0, \"value\": 300}]}],"
+    " \"companies\": [{\"name\": \"shop\", \"currency\": 0}],"
+    " \"external_exchanges\": [{\"account\": 0, \"company\": 0, \"category\": -1, \"value\": 100, \"when\": 1425168000},"
+    " {\"account\": 0, \"company\": 0, \"category\": -1, \"value\": 200, \"when\": 1425254400}]";
+
+  // a older file where the money already includes the exchanges
+  WriteFile(SNAPSHOT, ledger + "}");
+  auto f = Reopen();
+  EXPECT_EQ(300, f->GetBalance(0, 0));
+  EXPECT_TRUE(f->VerifyBalances());
+
+  // stored with no exchanges balanced, the money is a opening balance
+  WriteFile(SNAPSHOT, ledger + ", \"balanced_external_exchanges\": 0, \"balanced_internal_exchanges\": 0}");
+  f = Reopen();
+  EXPECT_EQ(600, f->GetBalance(0, 0));
+  RemoveLedger();
+}
+
+#ifdef FINANS_UNIX
+GTEST(TestFailedCompactKeepsTheLedger) {
+  auto f = OpenWithAccount();
+  f->Save();
+  f->AddExternalExchange(0, 0, -1, 100, 1425168000);
+  f->Save();
+  const auto snapshot = ReadFile(SNAPSHOT);
+  const auto journal = ReadFile(JOURNAL);
+
+  // a file can't be written where a directory is
+  const auto temp = SNAPSHOT + ".tmp";
+  ASSERT_EQ(0, mkdir(temp.c_str(), 0700));
+  f->AddExternalExchange(0, 0, -1, 200, 1425254400);
+  EXPECT_ANY_THROW(f->Compact());
+  rmdir(temp.c_str());
+  EXPECT_EQ(snapshot, ReadFile(SNAPSHOT));
+  EXPECT_EQ(journal, ReadFile(JOURNAL));
+
+  f = Reopen();
+  EXPECT_EQ(1, f->NumberOfExternalExchanges());
+  EXPECT_EQ(100, f->GetBalance(0, 0));
+  RemoveLedger();
+}
+#endif
+
+GTEST(TestNetWorthUsesTheRatesOfTheDay) {
+  UtcOffsetTable local_time;
+  const auto day = Day::FromCivil(2015, 3, 10);
+  const auto noon = [&](Day d) { return d.LocalStart(&local_time) + 12 * 60 * 60; };
+  auto f = OpenWithAccount();
+  f->AddCurency("American dollar", "USD", "$", "");
+  f->AddAccount("Dollars", "dollars", 1);
+  f->AddExternalExchange(1, 0, -1, 100, noon(day - 2));
+  f->AddRate(1, 0, 10.0, noon(day));
+  f->AddRate(1, 0, 20.0, noon(day + 1));
+
+  // a later rate isn't used for the past
+  EXPECT_ANY_THROW(f->GetNetWorth(0, (day - 1).LocalStart(&local_time)));
+  EXPECT_EQ(1000, f->GetNetWorth(0, (day + 1).LocalStart(&local_time)));
+  EXPECT_EQ(2000, f->GetNetWorth(0, (day + 2).LocalStart(&local_time)));
+  RemoveLedger();
+}
+
+GTEST(TestDamagedJournalIsNotLoaded) {
+  auto f = OpenWithAccount();
+  f->Save();
+  f->AddExternalExchange(0, 0, -1, 100, 1425168000);
+  f->AddExternalExchange(0, 0, -1, 200, 1425168000);
+  f->Save();
+  f.reset();
+  {
+    // flip a byte in the payload of the first exchange, the second is after it
+    std::fstream journal(JOURNAL.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    journal.seekp(16 + 8);
+    journal.put('\xff');
+  }
+  const auto snapshot = ReadFile(SNAPSHOT);
+  EXPECT_ANY_THROW(Reopen());
+  EXPECT_EQ(snapshot, ReadFile(SNAPSHOT));
+  RemoveLedger();
+}
+
+namespace {
+// the error of opening the snapshot, or a empty string
+std::string OpenError(const std::string& snapshot) {
+  RemoveLedger();
+  WriteFile(SNAPSHOT, snapshot);
+  try {
+    Reopen();
+  }
+  catch (const std::string& error) {
+    return error;
+  }
+  return "";
+}
+}  // namespace
+
+GTEST(TestBadIndicesAreNotLoaded) {
+  const std::string ledger = "\"currencies\": [{\"short_name\": \"SEK\"}], \"companies\": [{\"name\": \"shop\"}], ";
+  EXPECT_EQ("", OpenError("{" + ledger + "\"accounts\": [{\"short_name\": \"bank\"}], "
+    "\"external_exchanges\": [{\"account\": 0, \"category\": -1}]}"));
+  EXPECT_NE(std::string::npos, OpenError("{" + ledger + "\"accounts\": [{\"short_name\": \"bank\"}], "
+    "\"external_exchanges\": [{\"account\": 5, \"category\": -1}]}").find("Invalid account 5"));
+  EXPECT_NE(std::string::npos, OpenError("{" + ledger + "\"accounts\": [{\"short_name\": \"bank\"}], "
+    "\"external_exchanges\": [{\"account\": 0, \"category\": 0}]}").find("Invalid category 0"));
+  EXPECT_NE(std::string::npos, OpenError("{" + ledger + "\"accounts\": [{\"short_name\": \"bank\", \"prefered_currency\": 1}]}")
+    .find("Invalid currency 1"));
+  EXPECT_NE(std::string::npos, OpenError("{" + ledger + "\"accounts\": [{\"short_name\": \"bank\"}], "
+    "\"internal_exchanges\": [{\"from_account\": 0, \"to_account\": -1}]}").find("Invalid account -1"));
+  RemoveLedger();
+}
+
+GTEST(TestChangedOnDisk) {
+  auto f = OpenWithAccount();
+  f->Save();
+  EXPECT_FALSE(f->IsChangedOnDisk());
+
+  // our own saves are not changes
+  f->AddExternalExchange(0, 0, -1, 100, 1425168000);
+  f->Save();
+  EXPECT_FALSE(f->IsChangedOnDisk());
+
+  auto other = Reopen();
+  EXPECT_EQ(1, other->NumberOfExternalExchanges());
+  other->AddExternalExchange(0, 0, -1, 200, 1425168000);
+  other->Save();
+  EXPECT_TRUE(f->IsChangedOnDisk());
+  EXPECT_FALSE(other->IsChangedOnDisk());
+  RemoveLedger();
+}
+
+GTEST(TestCacheHitAndMiss) {
+  auto f = OpenWithAccount();
+  f->Compact();
+  f.reset();
+
+  f = OpenCached();
+  EXPECT_TRUE(f->load_timing().cache_enabled);
+  EXPECT_FALSE(f->load_timing().cache_hit);
+  f = OpenCached();
+  EXPECT_TRUE(f->load_timing().cache_hit);
+  EXPECT_EQ(0, f->GetAccountByName("bank"));
+
+  // a different size is a miss, and the miss updates the cache
+  WriteFile(SNAPSHOT, ReadFile(SNAPSHOT) + "\n");
+  f = OpenCached();
+  EXPECT_FALSE(f->load_timing().cache_hit);
+  f = OpenCached();
+  EXPECT_TRUE(f->load_timing().cache_hit);
+  RemoveLedger();
+}
+
+GTEST(TestCacheIsWrittenOnCompact) {
+  auto f = OpenWithAccount();
+  f->Compact();
+  f = OpenCached();
+  f->AddCategory("food");
+  f->Compact();
+
+  f = OpenCached();
+  EXPECT_TRUE(f->load_timing().cache_hit);
+  EXPECT_EQ(1, f->NumberOfCategories());
+  RemoveLedger();
+}
+
+GTEST(TestBinarySnapshotHasNoCache) {
+  const std::string binary = "testfinans.bin";
+  RemoveLedger();
+  ASSERT_EQ("", SaveProtoBinary(finans::Finans(), binary));
+
+  auto f = Finans::Open(binary, SnapshotFormat::BINARY, CACHE, JOURNAL_LIMIT);
+  EXPECT_FALSE(f->load_timing().cache_enabled);
+  EXPECT_FALSE(f->load_timing().cache_hit);
+  EXPECT_FALSE(FileExist(CACHE));
+  std::remove(binary.c_str());
+  RemoveLedger();
+}
+
+#ifdef FINANS_UNIX
+namespace {
+int64_t ModifiedTime(const std::string& path) {
+  int64_t size = 0;
+  int64_t modified = 0;
+  EXPECT_TRUE(GetFileInfo(path, &size, &modified));
+  return modified;
+}
+
+void SetModifiedTime(const std::string& path, int64_t modified) {
+  struct utimbuf times;
+  times.actime = static_cast<time_t>(modified);
+  times.modtime = static_cast<time_t>(modified);
+  EXPECT_EQ(0, utime(path.c_str(), &times));
+}
+}  // namespace
+
+GTEST(TestCacheMissOnModifiedTime) {
+  auto f = OpenWithAccount();
+  f->Compact();
+  f = OpenCached();
+  f = OpenCached();
+  EXPECT_TRUE(f->load_timing().cache_hit);
+
+  SetModifiedTime(SNAPSHOT, ModifiedTime(SNAPSHOT) + 100);
+  f = OpenCached();
+  EXPECT_FALSE(f->load_timing().cache_hit);
+  f = OpenCached();
+  EXPECT_TRUE(f->load_timing().cache_hit);
+  RemoveLedger();
+}
+
+GTEST(TestCacheMissOnContent) {
+  auto f = OpenWithAccount();
+  f->Compact();
+  f = OpenCached();
+  f.reset();
+
+  // same size and modification time, only the hash can tell
+  const auto modified = ModifiedTime(SNAPSHOT);
+  auto content = ReadFile(SNAPSHOT);
+  const auto name = content.find("\"bank\"");
+  ASSERT_NE(std::string::npos, name);
+  content.replace(name, 6, "\"bonk\"");
+  WriteFile(SNAPSHOT, content);
+  SetModifiedTime(SNAPSHOT, modified);
+
+  f = OpenCached();
+  EXPECT_FALSE(f->load_timing().cache_hit);
+  EXPECT_EQ(0, f->GetAccountByName("bonk"));
+  RemoveLedger();
+}
+
+GTEST(TestSummariesFollowTheTimeZone) {
+  // 2015-03-31 23:30 utc is in april in tokyo
+  const int64_t when = 1427844600;
+  {
+    ScopedTimeZone zone("UTC");
+    auto f = OpenWithAccount();
+    f->AddExternalExchange(0, 0, -1, 100, when);
+    f->Compact();
+    EXPECT_EQ(std::vector<int64_t>{ 1425168000 }, f->GetMonthlySummaries().GetMonths(0, std::numeric_limits<int64_t>::max()));
+  }
+
+  ScopedTimeZone zone("Asia/Tokyo");
+  auto f = Reopen();
+  const auto& summaries = f->GetMonthlySummaries();
+  const auto months = summaries.GetMonths(0, std::numeric_limits<int64_t>::max());
+  ASSERT_EQ(1u, months.size());
+  EXPECT_EQ(UtcOffsetTable().MonthStart(when), months[0]);
+  ASSERT_EQ(1u, summaries.GetRows(months[0]).size());
+  EXPECT_EQ(100, summaries.GetRows(months[0])[0].sum);
+  RemoveLedger();
+}
+#endif
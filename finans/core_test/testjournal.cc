@@ -0,0 +1,119 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/journal.h"
+
+#include <cstdio>
+#include <fstream>  // NOLINT this is how we use fstrean
+
+#include "gtest/gtest.h"
+
+#define GTEST(x) GTEST_TEST(journal, x)
+
+namespace {
+const std::string PATH = "test.journal";
+}
+
+GTEST(TestMissing) {
+  std::remove(PATH.c_str());
+  JournalContent content;
+  EXPECT_EQ("", ReadJournal(PATH, &content));
+  EXPECT_FALSE(content.exists);
+}
+
+GTEST(TestAppendAndRead) {
+  EXPECT_EQ("", ResetJournal(PATH, 42));
+  EXPECT_EQ("", AppendJournal(PATH, { "dog", "" }, nullptr));
+  uint64_t written = 0;
+  EXPECT_EQ("", AppendJournal(PATH, { "cat" }, &written));
+  EXPECT_EQ(11u, written);
+
+  JournalContent content;
+  EXPECT_EQ("", ReadJournal(PATH, &content));
+  EXPECT_TRUE(content.exists);
+  EXPECT_EQ(42, content.generation);
+  ASSERT_EQ(3u, content.records.size());
+  EXPECT_EQ("dog", content.records[0]);
+  EXPECT_EQ("", content.records[1]);
+  EXPECT_EQ("cat", content.records[2]);
+  EXPECT_EQ(content.file_size, content.valid_size);
+  std::remove(PATH.c_str());
+}
+
+GTEST(TestTornRecordIsIgnored) {
+  EXPECT_EQ("", ResetJournal(PATH, 1));
+  EXPECT_EQ("", AppendJournal(PATH, { "dog", "cat" }, nullptr));
+  {
+    // simulate a crash in the middle of writing a record
+    std::ofstream f(PATH.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+    f.write("\x05\x00\x00\x00\x00\x00\x00\x00ab", 10);
+  }
+
+  JournalContent content;
+  EXPECT_EQ("", ReadJournal(PATH, &content));
+  ASSERT_EQ(2u, content.records.size());
+  EXPECT_EQ("cat", content.records[1]);
+  EXPECT_EQ(content.file_size - 10, content.valid_size);
+  std::remove(PATH.c_str());
+}
+
+namespace {
+// flips a byte of the file
+void Damage(std::size_t offset) {
+  std::fstream f(PATH.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+  f.seekg(offset);
+  const auto c = static_cast<char>(f.get());
+  f.seekp(offset);
+  f.put(static_cast<char>(c ^ 0x20));
+}
+
+// 16 bytes of header and 11 for each record of 3 bytes
+const std::size_t FIRST_PAYLOAD = 16 + 8;
+const std::size_t SECOND_PAYLOAD = FIRST_PAYLOAD + 11;
+}  // namespace
+
+GTEST(TestDamagedLastRecordIsTorn) {
+  EXPECT_EQ("", ResetJournal(PATH, 1));
+  EXPECT_EQ("", AppendJournal(PATH, { "dog", "cat" }, nullptr));
+  Damage(SECOND_PAYLOAD);
+
+  JournalContent content;
+  EXPECT_EQ("", ReadJournal(PATH, &content));
+  ASSERT_EQ(1u, content.records.size());
+  EXPECT_EQ("dog", content.records[0]);
+  EXPECT_EQ(SECOND_PAYLOAD - 8, content.valid_size);
+  std::remove(PATH.c_str());
+}
+
+GTEST(TestDamagedRecordInTheMiddleIsAError) {
+  EXPECT_EQ("", ResetJournal(PATH, 1));
+  EXPECT_EQ("", AppendJournal(PATH, { "dog", "cat" }, nullptr));
+  Damage(FIRST_PAYLOAD);
+
+  JournalContent content;
+  EXPECT_NE("", ReadJournal(PATH, &content));
+  std::remove(PATH.c_str());
+}
+
+GTEST(TestDamagedSizeInTheMiddleIsAError) {
+  EXPECT_EQ("", ResetJournal(PATH, 1));
+  EXPECT_EQ("", AppendJournal(PATH, { "dog", "cat", "cow" }, nullptr));
+  // the size of the first record now goes past the end of the file
+  Damage(FIRST_PAYLOAD - 5);
+
+  JournalContent content;
+  EXPECT_NE("", ReadJournal(PATH, &content));
+  EXPECT_EQ(FIRST_PAYLOAD - 8, content.valid_size);
+  std::remove(PATH.c_str());
+}
+
+GTEST(TestResetRemovesRecords) {
+  EXPECT_EQ("", ResetJournal(PATH, 1));
+  EXPECT_EQ("", AppendJournal(PATH, { "dog" }, nullptr));
+  EXPECT_EQ("", ResetJournal(PATH, 2));
+
+  JournalContent content;
+  EXPECT_EQ("", ReadJournal(PATH, &content));
+  EXPECT_EQ(2, content.generation);
+  EXPECT_TRUE(content.records.empty());
+  std::remove(PATH.c_str());
+}
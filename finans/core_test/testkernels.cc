@@ -0,0 +1,79 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/kernels.h"
+
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#define GTEST(x) GTEST_TEST(kernels, x)
+
+namespace {
+const KernelLevel LEVELS[] = { KernelLevel::SCALAR, KernelLevel::SSE2, KernelLevel::AVX2 };
+
+struct Columns {
+  std::vector<int> values;
+  std::vector<int> accounts;
+  std::vector<int64_t> whens;
+};
+
+// odd size so the tail after the vector loop is tested too
+Columns MakeColumns() {
+  Columns c;
+  for (int i = 0; i < 1003; ++i) {
+    c.values.push_back(i % 5 == 0 ? std::numeric_limits<int>::max() : (i % 7 == 0 ? std::numeric_limits<int>::min() : i * 31 - 9000));
+    c.accounts.push_back(i % 3);
+    // crosses zero and the 32 bit boundary so the 64 bit compare is tested
+    c.whens.push_back((static_cast<int64_t>(i) - 500) * 10000000);
+  }
+  return c;
+}
+}  // namespace
+
+GTEST(TestSumValuesAllLevels) {
+  const auto c = MakeColumns();
+  int64_t expected = 0;
+  for (const auto v : c.values) expected += v;
+  for (const auto level : LEVELS) {
+    EXPECT_EQ(expected, SumValues(level, c.values.data(), c.values.size())) << KernelLevelName(level);
+  }
+}
+
+GTEST(TestSumValuesWhereAllLevels) {
+  const auto c = MakeColumns();
+  const int64_t from = -4990000000ll;
+  const int64_t to = 3000000000ll;
+  for (int account = 0; account < 4; ++account) {
+    int64_t expected = 0;
+    for (std::size_t i = 0; i < c.values.size(); ++i) {
+      if (c.accounts[i] == account && from <= c.whens[i] && c.whens[i] < to) expected += c.values[i];
+    }
+    for (const auto level : LEVELS) {
+      EXPECT_EQ(expected, SumValuesWhere(level, c.values.data(), c.accounts.data(), c.whens.data(), c.values.size(),
+                                         account, from, to)) << KernelLevelName(level);
+    }
+  }
+}
+
+GTEST(TestEmpty) {
+  EXPECT_EQ(0, SumValues(nullptr, 0));
+  EXPECT_EQ(0, SumValuesWhere(nullptr, nullptr, nullptr, 0, 0, 0, 1));
+}
+
+GTEST(TestSecondsToDaysAllLevels) {
+  // around midnight on both sides of the epoch, and a odd count for the tail
+  std::vector<int64_t> seconds;
+  for (int64_t day = -40000; day < 40000; day += 997) {
+    for (const int64_t second : { -1, 0, 1, 86399 }) seconds.push_back(day * 86400 + second);
+  }
+  seconds.push_back(1420070400);
+  for (const auto level : LEVELS) {
+    std::vector<int32_t> days(seconds.size());
+    SecondsToDays(level, seconds.data(), seconds.size(), days.data());
+    for (std::size_t i = 0; i < seconds.size(); ++i) {
+      const auto expected = seconds[i] >= 0 ? seconds[i] / 86400 : (seconds[i] - 86399) / 86400;
+      ASSERT_EQ(expected, days[i]) << KernelLevelName(level) << " " << seconds[i];
+    }
+  }
+}
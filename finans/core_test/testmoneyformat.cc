@@ -0,0 +1,46 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/moneyformat.h"
+
+#include <limits>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#define GTEST(x) GTEST_TEST(moneyformat, x)
+
+GTEST(TestNumber) {
+  const MoneyFormat f;
+  EXPECT_EQ("0.00", f.Format(0));
+  EXPECT_EQ("0.05", f.Format(5));
+  EXPECT_EQ("-0.05", f.Format(-5));
+  EXPECT_EQ("12.34", f.Format(1234));
+  EXPECT_EQ("999.99", f.Format(99999));
+  EXPECT_EQ("1,000.00", f.Format(100000));
+  EXPECT_EQ("-1,234,567.89", f.Format(-123456789));
+  EXPECT_EQ("-92,233,720,368,547,758.08", f.Format(std::numeric_limits<int64_t>::min()));
+}
+
+GTEST(TestBeforeAndAfter) {
+  EXPECT_EQ("$20.00", MoneyFormat("$", "").Format(2000));
+  EXPECT_EQ("-$1,000.50", MoneyFormat("$", "").Format(-100050));
+  EXPECT_EQ("20.00 kr", MoneyFormat("", "kr").Format(2000));
+  EXPECT_EQ("-20.00 kr", MoneyFormat("", "kr").Format(-2000));
+  EXPECT_EQ("SEK 20.00", MoneyFormat("SEK", "").Format(2000));
+  EXPECT_EQ("20.00%", MoneyFormat("", "%").Format(2000));
+}
+
+GTEST(TestPlain) {
+  EXPECT_EQ("1234.56 SEK", MoneyFormat::Plain("SEK").Format(123456));
+  EXPECT_EQ("-1234567.89 SEK", MoneyFormat::Plain("SEK").Format(-123456789));
+  EXPECT_EQ("0.05 $", MoneyFormat::Plain("$").Format(5));
+}
+
+GTEST(TestAppend) {
+  const MoneyFormat f("", "kr");
+  std::string out = "sum: ";
+  f.Append(150, &out);
+  out += ", ";
+  f.Append(-7, &out);
+  EXPECT_EQ("sum: 1.50 kr, -0.07 kr", out);
+}
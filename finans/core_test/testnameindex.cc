@@ -0,0 +1,35 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/nameindex.h"
+
+#include "gtest/gtest.h"
+
+#define GTEST(x) GTEST_TEST(nameindex, x)
+
+GTEST(TestMissing) {
+  NameIndex index;
+  EXPECT_EQ(-1, index.Find("dog"));
+}
+
+GTEST(TestIgnoresCase) {
+  NameIndex index;
+  index.Add("Dog", 0);
+  index.Add("cat", 1);
+  EXPECT_EQ(0, index.Find("dog"));
+  EXPECT_EQ(0, index.Find("DOG"));
+  EXPECT_EQ(1, index.Find("Cat"));
+}
+
+GTEST(TestFirstIsKept) {
+  NameIndex index;
+  index.Add("dog", 3);
+  index.Add("DOG", 5);
+  EXPECT_EQ(3, index.Find("dog"));
+}
+
+GTEST(TestClear) {
+  NameIndex index;
+  index.Add("dog", 0);
+  index.Clear();
+  EXPECT_EQ(-1, index.Find("dog"));
+}
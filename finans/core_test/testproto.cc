@@ -0,0 +1,100 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/proto.h"
+
+#include <cstdio>
+#include <fstream>  // NOLINT this is how we use fstrean
+#include <iterator>
+#include <string>
+
+#include "finans/core/finans-proto.h"
+
+#include "gtest/gtest.h"
+
+#define GTEST(x) GTEST_TEST(proto, x)
+
+namespace {
+const std::string PATH = "testproto.bin";
+
+finans::Finans MakeLedger() {
+  finans::Finans f;
+  auto* currency = f.add_currencies();
+  currency->set_short_name("SEK");
+  currency->set_value_after("kr");
+  auto* account = f.add_accounts();
+  account->set_short_name("bank");
+  for (int i = 0; i < 100; ++i) {
+    auto* e = f.add_external_exchanges();
+    e->set_account(0);
+    e->set_category(-1);
+    e->set_value(i * 100 - 5000);
+    e->set_when(1425168000 + i * 3600);
+  }
+  f.set_journal_generation(7);
+  return f;
+}
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream f(path.c_str(), std::ios::in | std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const std::string& path, const std::string& content) {
+  std::ofstream f(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  f.write(content.data(), content.size());
+}
+}  // namespace
+
+GTEST(TestBinaryRoundTrip) {
+  const auto saved = MakeLedger();
+  EXPECT_EQ("", SaveProtoBinary(saved, PATH));
+  EXPECT_TRUE(IsProtoBinary(PATH));
+
+  finans::Finans loaded;
+  EXPECT_EQ("", LoadProtoBinary(&loaded, PATH));
+  EXPECT_EQ(saved.SerializeAsString(), loaded.SerializeAsString());
+  std::remove(PATH.c_str());
+}
+
+GTEST(TestJsonIsNotBinary) {
+  EXPECT_EQ("", SaveProtoJson(MakeLedger(), PATH));
+  EXPECT_FALSE(IsProtoBinary(PATH));
+  finans::Finans loaded;
+  EXPECT_NE("", LoadProtoBinary(&loaded, PATH));
+  std::remove(PATH.c_str());
+}
+
+GTEST(TestEmptyAndMissingFiles) {
+  finans::Finans loaded;
+  std::remove(PATH.c_str());
+  EXPECT_FALSE(IsProtoBinary(PATH));
+  EXPECT_NE("", LoadProtoBinary(&loaded, PATH));
+
+  WriteFile(PATH, "");
+  EXPECT_FALSE(IsProtoBinary(PATH));
+  EXPECT_NE("", LoadProtoBinary(&loaded, PATH));
+  std::remove(PATH.c_str());
+}
+
+GTEST(TestTruncatedFiles) {
+  EXPECT_EQ("", SaveProtoBinary(MakeLedger(), PATH));
+  const auto data = ReadFile(PATH);
+  finans::Finans loaded;
+
+  // part of the magic is not a binary file
+  WriteFile(PATH, data.substr(0, 5));
+  EXPECT_FALSE(IsProtoBinary(PATH));
+  EXPECT_NE("", LoadProtoBinary(&loaded, PATH));
+
+  // the magic alone is a empty ledger
+  WriteFile(PATH, data.substr(0, 8));
+  EXPECT_TRUE(IsProtoBinary(PATH));
+  EXPECT_EQ("", LoadProtoBinary(&loaded, PATH));
+  EXPECT_EQ(0, loaded.external_exchanges_size());
+
+  // cut in the middle of a exchange
+  WriteFile(PATH, data.substr(0, data.size() - 3));
+  EXPECT_TRUE(IsProtoBinary(PATH));
+  EXPECT_NE("", LoadProtoBinary(&loaded, PATH));
+  std::remove(PATH.c_str());
+}
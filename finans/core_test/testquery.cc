@@ -0,0 +1,111 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/query.h"
+
+#include "finans/core/datetime.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+#define GTEST(x) GTEST_TEST(query, x)
+
+namespace {
+class TestNames : public QueryNames {
+public:
+  int GetAccountByName(const std::string& name) const override { return name == "bank" ? 0 : -1; }
+  int GetCompanyByName(const std::string& name) const override { return name == "ica" ? 3 : -1; }
+  int GetCurrencyByName(const std::string& name) const override { return name == "SEK" ? 0 : -1; }
+  int GetCategoryByName(const std::string& name) const override {
+    if (name == "Food") return 1;
+    if (name == "Eating out") return 2;
+    return -1;
+  }
+};
+}  // namespace
+
+GTEST(TestCompile) {
+  Query q;
+  EXPECT_EQ("", q.Compile("category=Food and value<-10000", TestNames()));
+  ASSERT_EQ(2u, q.conditions().size());
+  EXPECT_EQ(QueryField::CATEGORY, q.conditions()[0].field);
+  EXPECT_EQ(QueryOp::EQUAL, q.conditions()[0].op);
+  EXPECT_EQ(1, q.conditions()[0].operand);
+  EXPECT_EQ(QueryField::VALUE, q.conditions()[1].field);
+  EXPECT_EQ(QueryOp::LESS, q.conditions()[1].op);
+  EXPECT_EQ(-10000, q.conditions()[1].operand);
+}
+
+GTEST(TestQuotedAndUncategorized) {
+  Query q;
+  EXPECT_EQ("", q.Compile("category = \"Eating out\" AND category != -", TestNames()));
+  ASSERT_EQ(2u, q.conditions().size());
+  EXPECT_EQ(2, q.conditions()[0].operand);
+  EXPECT_EQ(-1, q.conditions()[1].operand);
+}
+
+GTEST(TestErrors) {
+  Query q;
+  EXPECT_NE("", q.Compile("category=Drinks", TestNames()));
+  EXPECT_NE("", q.Compile("color=red", TestNames()));
+  EXPECT_NE("", q.Compile("value<lots", TestNames()));
+  EXPECT_NE("", q.Compile("category<Food", TestNames()));
+  EXPECT_NE("", q.Compile("value<10 value>1", TestNames()));
+  EXPECT_NE("", q.Compile("when>=2015-13-01", TestNames()));
+  EXPECT_NE("", q.Compile("when>=2015-02-31", TestNames()));
+  EXPECT_NE("", q.Compile("when>=2015-02-01x", TestNames()));
+  EXPECT_NE("", q.Compile("account=", TestNames()));
+}
+
+GTEST(TestWhenIsLocalMidnight) {
+  Query q;
+  ASSERT_EQ("", q.Compile("when>=2016-02-29", TestNames()));
+  ASSERT_EQ(1u, q.conditions().size());
+  const auto midnight = DateTime::FromDateTime(2016, Month::FEBRUARY, 29, 0, 0, 0);
+  EXPECT_EQ(static_cast<int64_t>(DateTimeToInt64(midnight.time())), q.conditions()[0].operand);
+  const auto next = DateTime::FromDateTime(2016, Month::MARCH, 1, 0, 0, 0);
+  EXPECT_EQ(static_cast<int64_t>(DateTimeToInt64(next.time())), q.conditions()[0].operand_end);
+}
+
+GTEST(TestWhenIsTheWholeDay) {
+  UtcOffsetTable local_time;
+  const auto day = DaysFromCivil(2015, 3, 1);
+  const int64_t HOUR = 60 * 60;
+  ExchangeColumns c;
+  // the evening before, midnight, noon, the last second and the next morning
+  const int64_t whens[] = {
+    local_time.Midnight(day) - 2 * HOUR, local_time.Midnight(day), local_time.Midnight(day) + 12 * HOUR,
+    local_time.Midnight(day + 1) - 1, local_time.Midnight(day + 1) + 8 * HOUR
+  };
+  for (const auto when : whens) {
+    c.Add(0, 0, 3, -1, 100, when);
+  }
+
+  const auto run = [&c](const std::string& text) {
+    Query q;
+    EXPECT_EQ("", q.Compile(text, TestNames()));
+    return q.Run(c);
+  };
+  EXPECT_THAT(run("when=2015-03-01"), ElementsAre(1, 2, 3));
+  EXPECT_THAT(run("when!=2015-03-01"), ElementsAre(0, 4));
+  EXPECT_THAT(run("when<2015-03-01"), ElementsAre(0));
+  EXPECT_THAT(run("when<=2015-03-01"), ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(run("when>2015-03-01"), ElementsAre(4));
+  EXPECT_THAT(run("when>=2015-03-01"), ElementsAre(1, 2, 3, 4));
+}
+
+GTEST(TestRun) {
+  ExchangeColumns c;
+  for (int i = 0; i < 3000; ++i) {
+    // account, currency, company, category, value, when
+    c.Add(i % 2, 0, 3, i % 3 - 1, i - 1500, i);
+  }
+  Query q;
+  ASSERT_EQ("", q.Compile("account=bank and category=Food and value>=0 and value<12", TestNames()));
+  // account 0 is even i, category 1 is i % 3 == 2, value 0..11 is i 1500..1511
+  EXPECT_THAT(q.Run(c), ElementsAre(1502, 1508));
+
+  ASSERT_EQ("", q.Compile("", TestNames()));
+  EXPECT_EQ(3000u, q.Run(c).size());
+}
@@ -0,0 +1,96 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/rates.h"
+
+#include "finans/core_test/scopedtimezone.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+#define GTEST(x) GTEST_TEST(rates, x)
+
+namespace {
+const int64_t DAY = 24 * 60 * 60;
+}  // namespace
+
+GTEST(TestLookupByTime) {
+  RateTable t;
+  t.Add(0, 1, 10 * DAY, 2.0);
+  t.Add(0, 1, 20 * DAY, 4.0);
+  double r = 0;
+  ASSERT_TRUE(t.GetRate(0, 1, 15 * DAY, &r));
+  EXPECT_DOUBLE_EQ(2.0, r);
+  ASSERT_TRUE(t.GetRate(0, 1, 20 * DAY, &r));
+  EXPECT_DOUBLE_EQ(4.0, r);
+  // there is no rate before the first one
+  EXPECT_FALSE(t.GetRate(0, 1, 0, &r));
+  EXPECT_FALSE(t.GetRate(1, 0, 10 * DAY - 1, &r));
+  ASSERT_TRUE(t.GetRate(1, 0, 25 * DAY, &r));
+  EXPECT_DOUBLE_EQ(0.25, r);
+  EXPECT_FALSE(t.GetRate(0, 2, 25 * DAY, &r));
+  ASSERT_TRUE(t.GetRate(2, 2, 25 * DAY, &r));
+  EXPECT_DOUBLE_EQ(1.0, r);
+}
+
+GTEST(TestMatrixGoesThroughOtherCurrencies) {
+  RateTable t;
+  t.Add(0, 1, 0, 10.0);
+  t.Add(1, 2, 0, 0.5);
+  const auto& m = t.GetMatrix(4, DAY);
+  ASSERT_TRUE(m.Has(0, 2));
+  EXPECT_DOUBLE_EQ(5.0, m.Get(0, 2));
+  EXPECT_DOUBLE_EQ(0.2, m.Get(2, 0));
+  EXPECT_FALSE(m.Has(0, 3));
+  EXPECT_TRUE(m.Has(3, 3));
+}
+
+GTEST(TestMatrixIsUpdatedByNewRates) {
+  RateTable t;
+  t.Add(0, 1, 0, 10.0);
+  EXPECT_DOUBLE_EQ(10.0, t.GetMatrix(2, 5 * DAY).Get(0, 1));
+  t.Add(0, 1, 5 * DAY + 100, 11.0);
+  // the rate of the end of the day
+  EXPECT_DOUBLE_EQ(11.0, t.GetMatrix(2, 5 * DAY).Get(0, 1));
+  EXPECT_DOUBLE_EQ(10.0, t.GetMatrix(2, 4 * DAY).Get(0, 1));
+}
+
+GTEST(TestMatrixHasNoRateBeforeTheFirst) {
+  RateTable t;
+  t.Add(0, 1, 5 * DAY, 10.0);
+  EXPECT_FALSE(t.GetMatrix(2, 4 * DAY).Has(0, 1));
+  EXPECT_TRUE(t.GetMatrix(2, 5 * DAY).Has(0, 1));
+}
+
+GTEST(TestConvertValuesAt) {
+  RateTable t;
+  t.Add(1, 0, 0, 10.0);
+  t.Add(1, 0, 2 * DAY, 20.0);
+  const int currencies[] = { 0, 1, 1, 2 };
+  const int values[] = { 5, 3, 3, 100 };
+  const int64_t whens[] = { 0, DAY, 3 * DAY, 3 * DAY };
+  int64_t converted[4] = { 0 };
+  EXPECT_FALSE(ConvertValuesAt(t, 3, 0, currencies, values, whens, 4, converted));
+  EXPECT_THAT(converted, ElementsAre(5, 30, 60, 0));
+  EXPECT_TRUE(ConvertValuesAt(t, 3, 0, currencies, values, whens, 3, converted));
+}
+
+#ifdef FINANS_UNIX
+GTEST(TestDaysAreLocal) {
+  ScopedTimeZone zone("Asia/Tokyo");
+  const int64_t HOUR = 60 * 60;
+  RateTable t;
+  t.Add(1, 0, 0, 10.0);
+  // 01:00 on the second local day, still the first utc day
+  t.Add(1, 0, 2 * DAY - 8 * HOUR, 20.0);
+  // 23:00 on the first local day only sees the first rate
+  const int currencies[] = { 1, 1 };
+  const int values[] = { 1, 1 };
+  const int64_t whens[] = { 2 * DAY - 10 * HOUR, 2 * DAY - 8 * HOUR };
+  int64_t converted[2] = { 0 };
+  EXPECT_TRUE(ConvertValuesAt(t, 2, 0, currencies, values, whens, 2, converted));
+  EXPECT_THAT(converted, ElementsAre(10, 20));
+  EXPECT_DOUBLE_EQ(10.0, t.GetMatrix(2, 2 * DAY - 10 * HOUR).Get(1, 0));
+}
+#endif
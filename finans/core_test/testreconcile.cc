@@ -0,0 +1,67 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/reconcile.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+#define GTEST(x) GTEST_TEST(reconcile, x)
+
+namespace {
+// a monday at noon, far from any dst change
+const int64_t DAY = 24 * 60 * 60;
+const int64_t START = 1425297600;
+
+ReconcileRow Row(int account, int company, int value, int64_t when) {
+  ReconcileRow r;
+  r.account = account;
+  r.company = company;
+  r.value = value;
+  r.when = when;
+  r.status = ReconcileStatus::NEW;
+  return r;
+}
+}  // namespace
+
+GTEST(TestNewMatchedAndAmbiguous) {
+  ExchangeColumns ledger;
+  ledger.Add(0, 0, 1, -1, -500, START);  // 0 coffee
+  ledger.Add(0, 0, 2, -1, -9000, START + 60);  // 1 rent
+  ledger.Add(0, 0, 2, -1, -9000, START + 120);  // 2 rent, twice?
+  ledger.Add(1, 0, 1, -1, -500, START);  // 3 other account
+
+  ReconcileReport report;
+  report.rows.push_back(Row(0, 1, -500, START - 3600));  // same day, other time
+  report.rows.push_back(Row(0, 2, -9000, START));
+  report.rows.push_back(Row(0, 1, -500, START + DAY));  // next day
+  report.rows.push_back(Row(0, 3, -500, START));  // other company
+  Reconcile(ledger, { 0, 1, 2, 3 }, &report);
+
+  EXPECT_EQ(ReconcileStatus::MATCHED, report.rows[0].status);
+  EXPECT_THAT(report.rows[0].matches, ElementsAre(0));
+  EXPECT_EQ(ReconcileStatus::AMBIGUOUS, report.rows[1].status);
+  EXPECT_THAT(report.rows[1].matches, ElementsAre(1, 2));
+  EXPECT_EQ(ReconcileStatus::NEW, report.rows[2].status);
+  EXPECT_EQ(ReconcileStatus::NEW, report.rows[3].status);
+  EXPECT_EQ(2, report.added);
+  EXPECT_EQ(1, report.matched);
+  EXPECT_EQ(1, report.ambiguous);
+}
+
+GTEST(TestRepeatedExchangesMatchAsAGroup) {
+  ExchangeColumns ledger;
+  ledger.Add(0, 0, 1, -1, -500, START);
+  ledger.Add(0, 0, 1, -1, -500, START);
+
+  ReconcileReport report;
+  report.rows.push_back(Row(0, 1, -500, START));
+  report.rows.push_back(Row(0, 1, -500, START));
+  Reconcile(ledger, { 0, 1 }, &report);
+  EXPECT_EQ(2, report.matched);
+
+  // only the indices given are compared
+  Reconcile(ledger, { }, &report);
+  EXPECT_EQ(2, report.added);
+}
@@ -0,0 +1,88 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/rules.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+#define GTEST(x) GTEST_TEST(rules, x)
+
+GTEST(TestFindsLowestIdIgnoringCase) {
+  PatternMatcher m;
+  m.Add("spotify", 2);
+  m.Add("ICA", 1);
+  m.Add("ica maxi", 0);
+  m.Compile();
+  EXPECT_EQ(2, m.Find("SPOTIFY P1234"));
+  EXPECT_EQ(1, m.Find("Ica Nara"));
+  EXPECT_EQ(0, m.Find("xx ICA MAXI stormarknad"));
+  EXPECT_EQ(-1, m.Find("coop"));
+  EXPECT_EQ(-1, m.Find(""));
+}
+
+GTEST(TestEveryByteHasItsOwnClass) {
+  // utf-8 payees can use most byte values, no two bytes may share a class
+  // unless they are the same letter
+  PatternMatcher m;
+  for (int byte = 0; byte < 256; ++byte) {
+    m.Add(std::string(1, static_cast<char>(byte)) + "!", byte);
+  }
+  m.Compile();
+  for (int byte = 0; byte < 256; ++byte) {
+    const auto c = static_cast<char>(byte);
+    const auto expected = byte >= 'a' && byte <= 'z' ? byte - 'a' + 'A' : byte;
+    EXPECT_EQ(expected, m.Find(std::string(1, c) + "!")) << byte;
+    EXPECT_EQ(-1, m.Find(std::string(1, c))) << byte;
+  }
+}
+
+GTEST(TestFindsSuffixesAndOverlaps) {
+  PatternMatcher m;
+  m.Add("he", 0);
+  m.Add("she", 1);
+  m.Add("hers", 2);
+  m.Add("his", 3);
+  m.Compile();
+  EXPECT_EQ(0, m.Find("ushs she"));
+  EXPECT_EQ(-1, m.Find("ushs sh"));
+  EXPECT_EQ(0, m.Find("ushers"));
+  EXPECT_EQ(3, m.Find("this"));
+}
+
+GTEST(TestMatchesNaiveSearch) {
+  const std::vector<std::string> patterns = { "ab", "bca", "c", "aab", "bb" };
+  PatternMatcher m;
+  for (std::size_t i = 0; i < patterns.size(); ++i) m.Add(patterns[i], static_cast<int>(i));
+  m.Compile();
+  // every string of a, b and c up to length 6
+  for (int length = 0; length <= 6; ++length) {
+    int combinations = 1;
+    for (int i = 0; i < length; ++i) combinations *= 3;
+    for (int n = 0; n < combinations; ++n) {
+      std::string text;
+      for (int i = 0, v = n; i < length; ++i, v /= 3) text += static_cast<char>('a' + v % 3);
+      int expected = -1;
+      for (std::size_t i = 0; i < patterns.size() && expected == -1; ++i) {
+        if (text.find(patterns[i]) != std::string::npos) expected = static_cast<int>(i);
+      }
+      EXPECT_EQ(expected, m.Find(text)) << text;
+    }
+  }
+}
+
+GTEST(TestFirstRuleWinsAndHitsAreCounted) {
+  Rules rules;
+  rules.Add("ica", "food", "ICA");
+  rules.Add("maxi", "", "");
+  rules.Compile();
+  EXPECT_EQ(0, rules.Find("maxi ica"));
+  EXPECT_EQ(1, rules.Find("maxi"));
+  rules.AddHit(1);
+  rules.AddHit(1);
+  EXPECT_EQ(0, rules.rules()[0].hits);
+  EXPECT_EQ(2, rules.rules()[1].hits);
+}
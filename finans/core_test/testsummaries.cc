@@ -0,0 +1,56 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/summaries.h"
+
+#include <limits>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+#define GTEST(x) GTEST_TEST(summaries, x)
+
+namespace {
+const int64_t ALL_FROM = std::numeric_limits<int64_t>::min();
+const int64_t ALL_TO = std::numeric_limits<int64_t>::max();
+}  // namespace
+
+GTEST(TestBuilderSortsAndSums) {
+  SummaryBuilder b;
+  b.Add(1, 0, 0, 10);
+  b.Add(0, 2, 0, 5);
+  b.Add(0, -1, 0, 7);
+  b.Add(1, 0, 0, -3);
+  const auto rows = b.GetRows();
+  ASSERT_EQ(3u, rows.size());
+  EXPECT_EQ(0, rows[0].account);
+  EXPECT_EQ(-1, rows[0].category);
+  EXPECT_EQ(2, rows[1].category);
+  EXPECT_EQ(1, rows[2].account);
+  EXPECT_EQ(7, rows[2].sum);
+  EXPECT_EQ(2, rows[2].count);
+}
+
+GTEST(TestInvalidate) {
+  MonthlySummaries s;
+  SummaryBuilder b;
+  b.Add(0, 0, 0, 100);
+  s.SetMonth(100, b.GetRows());
+  s.SetMonth(200, b.GetRows());
+  EXPECT_TRUE(s.IsValid());
+  EXPECT_THAT(s.GetMonths(ALL_FROM, ALL_TO), ElementsAre(100, 200));
+
+  s.Invalidate(200);
+  s.Invalidate(300);
+  EXPECT_FALSE(s.IsValid());
+  EXPECT_THAT(s.GetInvalidMonths(), ElementsAre(200, 300));
+  EXPECT_THAT(s.GetMonths(ALL_FROM, ALL_TO), ElementsAre(100));
+  EXPECT_THAT(s.GetRows(200), IsEmpty());
+  EXPECT_EQ(1u, s.GetRows(100).size());
+
+  s.SetMonth(200, b.GetRows());
+  s.SetMonth(300, std::vector<SummaryRow>());
+  EXPECT_TRUE(s.IsValid());
+  EXPECT_THAT(s.GetMonths(150, 300), ElementsAre(200));
+}
@@ -0,0 +1,36 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/threadpool.h"
+
+#include <atomic>
+
+#include "gtest/gtest.h"
+
+#define GTEST(x) GTEST_TEST(threadpool, x)
+
+GTEST(TestRunsAll) {
+  std::atomic<int> sum(0);
+  ThreadPool pool(3);
+  EXPECT_EQ(3, pool.size());
+  for (int i = 1; i <= 100; ++i) {
+    pool.Add([&sum, i]() { sum += i; });
+  }
+  pool.Wait();
+  EXPECT_EQ(5050, sum.load());
+}
+
+GTEST(TestWaitTwice) {
+  std::atomic<int> count(0);
+  ThreadPool pool(2);
+  pool.Wait();
+  pool.Add([&count]() { ++count; });
+  pool.Wait();
+  pool.Add([&count]() { ++count; });
+  pool.Wait();
+  EXPECT_EQ(2, count.load());
+}
+
+GTEST(TestDefaultUsesCores) {
+  ThreadPool pool(0);
+  EXPECT_EQ(ThreadPool::NumberOfCores(), pool.size());
+}
@@ -0,0 +1,65 @@
+// Copyright (2015) Gustav
+
+#include "finans/core/timeindex.h"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+#define GTEST(x) GTEST_TEST(timeindex, x)
+
+namespace {
+std::vector<int> ToVector(const TimeIndex::Slice& slice) {
+  return std::vector<int>(slice.begin(), slice.end());
+}
+}
+
+GTEST(TestEmpty) {
+  TimeIndex index;
+  EXPECT_TRUE(index.Range(0, 100).empty());
+}
+
+GTEST(TestBuildSorts) {
+  TimeIndex index;
+  index.Build({ 30, 10, 20, 10 });
+  EXPECT_THAT(ToVector(index.All()), ElementsAre(1, 3, 2, 0));
+}
+
+GTEST(TestRangeIsHalfOpen) {
+  TimeIndex index;
+  index.Build({ 10, 20, 30, 40 });
+  EXPECT_THAT(ToVector(index.Range(20, 40)), ElementsAre(1, 2));
+  EXPECT_THAT(ToVector(index.Range(0, 11)), ElementsAre(0));
+  EXPECT_THAT(ToVector(index.Range(41, 100)), IsEmpty());
+  EXPECT_THAT(ToVector(index.Range(30, 30)), IsEmpty());
+}
+
+GTEST(TestAddInOrder) {
+  TimeIndex index;
+  index.Add(10, 0);
+  index.Add(20, 1);
+  index.Add(20, 2);
+  EXPECT_THAT(ToVector(index.Range(20, 21)), ElementsAre(1, 2));
+}
+
+GTEST(TestAddOutOfOrder) {
+  TimeIndex index;
+  index.Add(10, 0);
+  index.Add(30, 1);
+  index.Add(20, 2);
+  index.Add(10, 3);
+  EXPECT_THAT(ToVector(index.All()), ElementsAre(0, 3, 2, 1));
+}
+
+GTEST(TestAddAllMerges) {
+  TimeIndex index;
+  const std::vector<int64_t> whens = { 10, 30, 40, 20, 10, 50, 30 };
+  index.Build(std::vector<int64_t>(whens.begin(), whens.begin() + 3));
+  index.AddAll(whens, 3);
+  EXPECT_THAT(ToVector(index.All()), ElementsAre(0, 4, 3, 1, 6, 2, 5));
+
+  TimeIndex built;
+  built.Build(whens);
+  EXPECT_THAT(ToVector(index.All()), ElementsAreArray(ToVector(built.All())));
+}